@@ -0,0 +1,498 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#include <tbb/blocked_range.h>
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+#include "tbb/task_group.h"
+
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#include "main.hpp"
+
+// every result is one JSON object per line:
+// {"suite":..,"name":..,"params":{..},"threads":..,"ops":..,"reps":..,"ns_min":..,"ns_median":..,"ns_per_op":..}
+class mm_bench
+{
+public:
+	mm_bench(std::ostream& out, const std::string& filter, const std::size_t reps) : \
+		m_out(out), m_filter(filter), m_reps(reps) {};
+
+public:
+	bool enabled(const std::string& suite, const std::string& name) const {
+		return m_filter.empty() || ((suite + "/" + name).find(m_filter) != std::string::npos);
+	}
+
+	// times m_reps runs of run after one warm-up run; setup is untimed and precedes every run
+	template<class _Setup, class _Run>
+	void measure(const std::string& suite, const std::string& name, const std::string& params, \
+		const std::size_t ops, _Setup setup, _Run run, std::size_t reps = 0L)
+	{
+		if (enabled(suite, name) == false) return;
+
+		reps = (reps > 0L) ? reps : m_reps;
+
+		std::vector<double> times_ns;
+		for (std::size_t rr = 0; rr <= reps; rr++)
+		{
+			setup();
+
+			auto time_s = std::chrono::steady_clock::now();
+			run();
+			auto time_f = std::chrono::steady_clock::now();
+
+			if (rr > 0L) times_ns.push_back(\
+				std::chrono::duration<double, std::nano>(time_f - time_s).count());
+		}
+
+		std::sort(times_ns.begin(), times_ns.end());
+		double median_ns = times_ns[times_ns.size() / 2];
+
+		m_out << "{\"suite\":\"" << suite << "\",\"name\":\"" << name << "\",\"params\":{" << params << "}" \
+			<< ",\"threads\":" << mm_topology::threads() << ",\"ops\":" << ops << ",\"reps\":" << reps \
+			<< std::fixed << std::setprecision(1) << ",\"ns_min\":" << times_ns.front() \
+			<< ",\"ns_median\":" << median_ns << ",\"ns_per_op\":" << median_ns / ops << "}\n";
+		m_out.flush();
+	}
+
+private:
+	std::ostream&		m_out;
+	const std::string	m_filter;
+	const std::size_t	m_reps;
+};
+
+static volatile std::size_t g_bench_sink = 0L;
+
+void random_set(std::mt19937& rng, std::vector<MMN_ITEM_ID>& items, \
+	const std::size_t items_size, const std::size_t universe)
+{
+	items.clear();
+	while (items.size() < items_size) {
+		items.push_back(static_cast<MMN_ITEM_ID>(rng() % universe));
+		std::sort(items.begin(), items.end());
+		items.erase(std::unique(items.begin(), items.end()), items.end());
+	}
+}
+
+// a context ready for mining: loaded, indexed and with its first level ranked
+MMN_TRANS_CONTEXT* prepare_dataset(mm_model& model, const std::string& dataset, \
+	MMN_RULE*& cnds_buf, std::size_t& cnds_size, minmax_conf_type& minmax_conf)
+{
+	MMN_TRANS_CONTEXT* trans_ctx = nullptr;
+	model.load_trans_from_file(dataset.c_str(), trans_ctx);
+
+	cnds_size = trans_ctx->m_stats.m_items_cnt;
+	parallel_max_miner::init_model(cnds_buf, trans_ctx, cnds_size, minmax_conf);
+	mm_bitmap::build_index(trans_ctx->m_tidsets, trans_ctx, cnds_buf, cnds_size);
+
+	std::stable_sort(cnds_buf, cnds_buf + cnds_size, \
+		[&](const MMN_RULE& r1, const MMN_RULE& r2) {
+			return r1.m_supp_ab < r2.m_supp_ab;
+		});
+
+	return trans_ctx;
+}
+
+// rules of 2..8 items over a universe of 64 items, a quarter of them repeated
+void random_rules(std::mt19937& rng, MMN_RULE*& rules_buf, \
+	const std::size_t rules, sycl_usm_arena& arena)
+{
+	sycl_usm_alloc_helper usm_alloc(\
+		"mm_bench buffers", USM_ALLOC_TYPE::usm_alloc_crt, &arena);
+
+	rules_buf = nullptr;
+	usm_alloc.alloc_buffer<MMN_RULE>(rules_buf, rules);
+
+	std::vector<MMN_ITEM_ID> items;
+	for (std::size_t ii = 0; ii < rules; ii++)
+	{
+		if ((ii > 0L) && (rng() % 4 == 0)) {
+			const MMN_RULE& rule = rules_buf[rng() % ii];
+			items.assign(rule.m_v, rule.m_v + rule.m_items);
+		}
+
+		else random_set(rng, items, 2 + rng() % 7, 64);
+
+		rules_buf[ii].m_items = items.size();
+		rules_buf[ii].m_supp_ab = rules_buf[ii].m_conf = 1.0f;
+		usm_alloc.alloc_buffer<MMN_ITEM_ID>(rules_buf[ii].m_v, items.size());
+		std::memcpy(rules_buf[ii].m_v, items.data(), items.size() * sizeof(MMN_ITEM_ID));
+	}
+}
+
+void bench_micro(mm_bench& bench, const std::string& dataset)
+{
+	std::mt19937 rng(2020);
+
+	for (std::size_t len : { 4, 16, 64, 256 })
+	{
+		const std::size_t pairs = 1024;
+		std::vector<std::vector<MMN_ITEM_ID>> sets(2 * pairs);
+		for (auto& set : sets)
+			random_set(rng, set, len, 4 * len);
+
+		std::vector<MMN_ITEM_ID> union_buf(2 * len);
+		std::string params = "\"len\":" + std::to_string(len);
+
+		bench.measure("micro", "intersect_vec", params, pairs, [] {}, [&] {
+			std::size_t sum = 0L;
+			for (std::size_t pp = 0; pp < pairs; pp++)
+				sum += mm_vector::intersect_vec(sets[2 * pp].data(), len, sets[2 * pp + 1].data(), len);
+			g_bench_sink = sum;
+		});
+
+		bench.measure("micro", "union_vec", params, pairs, [] {}, [&] {
+			std::size_t sum = 0L;
+			for (std::size_t pp = 0; pp < pairs; pp++)
+				sum += mm_vector::union_vec(sets[2 * pp].data(), len, \
+					sets[2 * pp + 1].data(), len, union_buf.data());
+			g_bench_sink = sum;
+		});
+	}
+
+	if (bench.enabled("micro", "get_support") == true)
+	{
+		mm_model model;
+		MMN_RULE* cnds_buf = nullptr;
+		std::size_t cnds_size = 0L;
+		minmax_conf_type minmax_conf;
+		MMN_TRANS_CONTEXT* trans_ctx = prepare_dataset(\
+			model, dataset, cnds_buf, cnds_size, minmax_conf);
+
+		trans_range_type trans_range = \
+			std::make_pair(0, trans_ctx->m_stats.m_trans_cnt);
+
+		for (std::size_t len : { 2, 4, 8 })
+		{
+			const std::size_t queries = 256;
+			std::vector<std::vector<MMN_ITEM_ID>> sets(queries);
+			for (auto& set : sets)
+			{
+				std::vector<MMN_ITEM_ID> ranks;
+				random_set(rng, ranks, std::min(len, cnds_size), cnds_size);
+
+				set.clear();
+				for (auto rank : ranks)
+					set.push_back(cnds_buf[rank].m_v[0]);
+				std::sort(set.begin(), set.end());
+			}
+
+			MMN_TIDSET_INDEX* tidsets = trans_ctx->m_tidsets;
+			for (const char* index : { "bitmap", "scan" })
+			{
+				std::string params = "\"dataset\":\"" + dataset + "\",\"len\":" + \
+					std::to_string(len) + ",\"index\":\"" + index + "\"";
+
+				trans_ctx->m_tidsets = (std::string(index) == "bitmap") ? tidsets : nullptr;
+				bench.measure("micro", "get_support", params, queries, [] {}, [&] {
+					double sum = .0f;
+					for (auto& set : sets)
+						sum += parallel_max_miner::get_support(set.data(), set.size(), trans_ctx, trans_range);
+					g_bench_sink = static_cast<std::size_t>(sum);
+				});
+			}
+
+			trans_ctx->m_tidsets = tidsets;
+		}
+	}
+
+	for (std::size_t cnds : { 10000, 100000 })
+	{
+		sycl_usm_arena store_arena("mm_bench buffers");
+		sycl_usm_arena filter_arena("mm_bench buffers");
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_bench buffers", USM_ALLOC_TYPE::usm_alloc_crt, &store_arena);
+
+		MMN_CNDS_STORE cnds_store = {};
+		usm_alloc.alloc_cnds_store(cnds_store, cnds, 4 * cnds);
+		for (std::size_t ii = 0; ii < cnds; ii++) {
+			cnds_store.m_offs[ii] = 4 * ii; cnds_store.m_items[ii] = 4;
+			cnds_store.m_supp_ab[ii] = static_cast<double>(rng() % 1000);
+		}
+
+		auto pred = [](const MMN_CNDS_STORE& store, const std::size_t ii) {
+			return store.m_supp_ab[ii] >= 500.0f;
+		};
+
+		std::string params = "\"cnds\":" + std::to_string(cnds);
+
+		bench.measure("micro", "filter_cands/parallel_for", params, cnds, [&] { filter_arena.reset(); }, [&] {
+			MMN_CNDS_STORE cnds_new_store = {};
+			parallel_max_miner::filter_cands(cnds_store, cnds_new_store, pred, &filter_arena);
+			g_bench_sink = cnds_new_store.m_cnds;
+		});
+
+		// the same kernel chain on every backend the build offers
+		auto measure_chain = [&](auto backend) {
+			typedef decltype(backend) backend_type;
+			bench.measure("micro", std::string("filter_cands/") + backend_type::name, params, cnds, \
+				[&] { filter_arena.reset(); }, [&] {
+					typename backend_type::event_type event;
+					MMN_CNDS_STORE cnds_new_store = {};
+					event = parallel_max_miner::filter_cands(cnds_store, \
+						cnds_new_store, pred, event, backend, &filter_arena);
+					event.wait(); g_bench_sink = cnds_new_store.m_cnds;
+				});
+		};
+
+		measure_chain(mm_backend_tbb{});
+#if defined(__cpp_lib_parallel_algorithm)
+		measure_chain(mm_backend_std{});
+#endif
+#if defined(MM_BACKEND_SYCL)
+		measure_chain(mm_backend_sycl{});
+#endif
+	}
+
+	for (std::size_t rules : { 10000, 100000 })
+	{
+		std::vector<MMN_RULE> rules_src(rules, MMN_RULE{}), rules_buf;
+		for (auto& rule : rules_src)
+			rule.m_supp_ab = static_cast<double>(rng() % 1000);
+
+		bench.measure("micro", "qsort3w", "\"rules\":" + std::to_string(rules), rules, \
+			[&] { rules_buf = rules_src; }, [&] {
+				qsort3w(rules_buf, 0, rules - 1, [](const MMN_RULE& r1, const MMN_RULE& r2) {
+					return r1.m_supp_ab < r2.m_supp_ab; });
+			});
+	}
+}
+
+void bench_phase(mm_bench& bench, const std::vector<std::string>& datasets)
+{
+	std::mt19937 rng(2020);
+
+	for (auto& dataset : datasets)
+	{
+		std::string params = "\"dataset\":\"" + dataset + "\"";
+
+		{
+			std::unique_ptr<mm_model> model;
+			MMN_TRANS_CONTEXT* trans_ctx = nullptr;
+			bench.measure("phase", "load_trans_from_file", params, 1L, \
+				[&] { trans_ctx = nullptr; model.reset(new mm_model()); }, \
+				[&] { model->load_trans_from_file(dataset.c_str(), trans_ctx); });
+		}
+
+		// every phase loads its own context, untimed, so it does not depend on another one running
+		if (bench.enabled("phase", "init_model") == true)
+		{
+			mm_model model;
+			MMN_TRANS_CONTEXT* trans_ctx = nullptr;
+			model.load_trans_from_file(dataset.c_str(), trans_ctx);
+
+			MMN_RULE* cnds_buf = nullptr;
+			std::size_t cnds_size = 0L;
+			sycl_usm_alloc_helper usm_alloc("mm_bench buffers");
+			bench.measure("phase", "init_model", params, 1L, [&] {
+					usm_alloc.free_cnds_buf(cnds_buf, cnds_size);
+					cnds_size = trans_ctx->m_stats.m_items_cnt;
+				}, [&] {
+					minmax_conf_type minmax_conf;
+					parallel_max_miner::init_model(cnds_buf, trans_ctx, cnds_size, minmax_conf);
+				});
+
+			usm_alloc.free_cnds_buf(cnds_buf, cnds_size);
+		}
+
+		if (bench.enabled("phase", "gen_sub_nodes") == true)
+		{
+			mm_model level_model;
+			MMN_RULE* cnds_buf = nullptr;
+			std::size_t cnds_size = 0L;
+			minmax_conf_type minmax_conf;
+			MMN_TRANS_CONTEXT* level_ctx = prepare_dataset(\
+				level_model, dataset, cnds_buf, cnds_size, minmax_conf);
+
+			trans_range_type trans_range = \
+				std::make_pair(0, level_ctx->m_stats.m_trans_cnt);
+
+			mm_backend_default backend;
+
+			sycl_usm_arena levels_arena("mm_bench buffers");
+			sycl_usm_arena level_arena("mm_level buffers", \
+				g_arena_slab_size, mm_backend_default::shared_alloc);
+			sycl_usm_arena scratch_arena("mm_scratch buffers", \
+				g_arena_slab_size, mm_backend_default::shared_alloc);
+			sycl_usm_alloc_helper usm_alloc(\
+				"mm_bench buffers", USM_ALLOC_TYPE::usm_alloc_crt, &levels_arena);
+
+			mm_itemset_trie maximal_trie;
+			std::vector<MMN_CNDS_STORE> levels(1, MMN_CNDS_STORE{});
+			usm_alloc.alloc_cnds_store(levels[0], cnds_size, mm_store::pool_size(cnds_buf, cnds_size));
+			mm_store::from_rules(cnds_buf, cnds_size, levels[0]);
+
+			// the input of level k + 1 is built once, untimed, from level k
+			for (std::size_t step = 0; step < 2; step++)
+			{
+				if (levels.back().m_cnds == 0L) break;
+
+				MMN_CNDS_STORE cnds_new_store = {}, cnds_max_store = {};
+				bench.measure("phase", "gen_sub_nodes", params + ",\"level\":" + std::to_string(step + 1) + \
+					",\"backend\":\"" + mm_backend_default::name + "\"", \
+					levels.back().m_cnds, [&] { level_arena.reset(); scratch_arena.reset(); }, [&] {
+						mm_backend_default::event_type event;
+						event = parallel_max_miner::gen_sub_nodes(levels.back(), cnds_new_store, \
+							cnds_max_store, level_ctx, &maximal_trie, \
+							parallel_max_miner::get_mean_conf(minmax_conf), trans_range, \
+							event, backend, level_arena, scratch_arena);
+						event.wait();
+					});
+
+				MMN_CNDS_STORE cnds_next_store = {};
+				usm_alloc.alloc_cnds_store(cnds_next_store, \
+					cnds_new_store.m_cnds, cnds_new_store.m_pool_size);
+				for (std::size_t ii = 0, pool_offs = 0; ii < cnds_new_store.m_cnds; ii++) {
+					mm_store::copy_cnd(cnds_new_store, ii, cnds_next_store, ii, pool_offs);
+					pool_offs += cnds_new_store.m_items[ii];
+				}
+
+				levels.push_back(cnds_next_store);
+			}
+		}
+	}
+
+	for (std::size_t rules : { 1000, 10000 })
+	{
+		sycl_usm_arena rules_arena("mm_bench buffers");
+
+		MMN_RULE* rules_buf = nullptr;
+		std::size_t rules_size = 0L;
+		std::string params = "\"rules\":" + std::to_string(rules);
+
+		auto setup = [&] {
+			rules_arena.reset(); rules_size = rules;
+			random_rules(rng, rules_buf, rules, rules_arena);
+		};
+
+		bench.measure("phase", "remove_duplicates", params, rules, setup, \
+			[&] { parallel_max_miner::remove_duplicates(rules_buf, rules_size, &rules_arena); });
+
+		bench.measure("phase", "remove_subsets", params, rules, setup, \
+			[&] { parallel_max_miner::remove_subsets(rules_buf, rules_size, &rules_arena); });
+	}
+}
+
+void bench_e2e(mm_bench& bench, const std::vector<std::string>& datasets, const std::size_t reps)
+{
+	// the thread count of the run is restored once the sweep is over
+	const std::size_t threads_max = mm_topology::threads();
+
+	std::vector<std::size_t> threads_list;
+	for (std::size_t threads = 1; threads < threads_max; threads *= 2)
+		threads_list.push_back(threads);
+	threads_list.push_back(threads_max);
+
+	for (auto& dataset : datasets)
+		for (auto threads : threads_list)
+		{
+			mm_topology::set_threads(threads);
+
+			std::unique_ptr<mm_model> model;
+			MMN_TRANS_CONTEXT* trans_ctx = nullptr;
+
+			MMN_RULE* rules_buf = nullptr;
+			std::size_t rules_size = 0L;
+			sycl_usm_alloc_helper rules_alloc(\
+				"mm_rule buffers", USM_ALLOC_TYPE::usm_alloc_crt);
+
+			bench.measure("e2e", "compute", "\"dataset\":\"" + dataset + \
+				"\",\"backend\":\"" + mm_backend_default::name + "\"", 1L, [&] {
+					rules_alloc.free_cnds_buf(rules_buf, rules_size);
+					trans_ctx = nullptr; rules_size = 0L;
+					model.reset(new mm_model());
+					model->load_trans_from_file(dataset.c_str(), trans_ctx);
+				}, [&] {
+					parallel_max_miner::compute(trans_ctx, rules_buf, rules_size);
+				}, reps);
+
+			rules_alloc.free_cnds_buf(rules_buf, rules_size);
+		}
+
+	mm_topology::set_threads(threads_max);
+}
+
+// the latency of appending a batch to an incremental run that holds the rest of the dataset
+void bench_incremental(mm_bench& bench, const std::vector<std::string>& datasets)
+{
+	const double min_supp = .02f;
+	const std::size_t batches[] = { 16L, 256L, 4096L };
+
+	for (auto& dataset : datasets)
+	{
+		if (bench.enabled("incremental", "append") == false) continue;
+
+		mm_model model;
+		MMN_TRANS_CONTEXT* trans_ctx = nullptr;
+		model.load_trans_from_file(dataset.c_str(), trans_ctx);
+
+		const std::size_t batch_max = batches[sizeof(batches) / sizeof(batches[0]) - 1];
+		if (trans_ctx->m_stats.m_trans_cnt <= batch_max) continue;
+
+		// a batch is a window of the loaded context, as the items are numbered the same way
+		MMN_TRANS_CONTEXT base_ctx = *trans_ctx;
+		base_ctx.m_stats.m_trans_cnt -= batch_max;
+
+		mm_incremental base(min_supp);
+		base.append(&base_ctx);
+
+		for (auto batch : batches)
+		{
+			MMN_TRANS_CONTEXT batch_ctx = *trans_ctx;
+			batch_ctx.m_trans += base_ctx.m_stats.m_trans_cnt;
+			batch_ctx.m_stats.m_trans_cnt = batch;
+
+			std::unique_ptr<mm_incremental> incremental;
+			bench.measure("incremental", "append", "\"dataset\":\"" + dataset + \
+				"\",\"base\":" + std::to_string(base_ctx.m_stats.m_trans_cnt) + \
+				",\"min_supp\":" + std::to_string(min_supp), batch, \
+				[&] { incremental.reset(new mm_incremental(base)); }, \
+				[&] { incremental->append(&batch_ctx); });
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::size_t reps = 7L, e2e_reps = 3L;
+	std::string filter, out_filename;
+	std::vector<std::string> datasets;
+
+	// -d <csv> (repeatable) selects the datasets, -f <substring> the benchmarks,
+	// -r <reps> the repetitions and -o <file> the output, which is stdout otherwise
+	for (int ii = 1; ii < argc - 1; ii += 2) {
+		std::string arg(argv[ii]);
+		if (arg == "-d") datasets.push_back(argv[ii + 1]);
+		else if (arg == "-f") filter = argv[ii + 1];
+		else if (arg == "-r") reps = e2e_reps = std::strtoull(argv[ii + 1], nullptr, 10);
+		else if (arg == "-o") out_filename = argv[ii + 1];
+		else if (arg == "-t") mm_topology::set_threads(std::strtoull(argv[ii + 1], nullptr, 10));
+	}
+
+	if (datasets.empty() == true)
+		datasets = { "input10.csv", "input50.csv" };
+
+	std::ofstream out_file;
+	if (out_filename.empty() == false)
+		out_file.open(out_filename, std::ios::trunc);
+
+	mm_bench bench(out_file.is_open() ? out_file : std::cout, filter, std::max<std::size_t>(1L, reps));
+
+	bench_micro(bench, datasets.front());
+	bench_phase(bench, datasets);
+	bench_e2e(bench, datasets, std::max<std::size_t>(1L, e2e_reps));
+	bench_incremental(bench, datasets);
+
+	return 0;
+}
@@ -0,0 +1,205 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <charconv>
+#include <iostream>
+#include <algorithm>
+
+// transactions are generated in blocks, each from its own seeded stream, so the output
+// depends on the parameters and the seed only, not on the number of threads
+constexpr std::size_t g_gen_block_trans = 1L << 16;
+constexpr std::size_t g_gen_batch_blocks = 64L;
+constexpr double g_gen_max_corruption = .9f;
+
+typedef struct {
+	std::size_t m_trans;
+	std::size_t m_items;
+	double m_trans_len;
+	std::size_t m_patterns;
+	double m_pattern_len;
+	double m_correlation;
+	double m_corruption;
+	std::uint64_t m_seed;
+} MMN_GEN_PARAMS;
+
+typedef struct {
+	std::vector<std::uint32_t> m_items;
+	double m_corruption;
+} MMN_GEN_PATTERN;
+
+// the potentially frequent itemsets of the IBM Quest generator: each pattern takes an
+// exponentially distributed fraction (mean m_correlation) of its predecessor's items,
+// the rest are drawn at random; patterns are weighted by an exponential distribution
+// and corrupted with a normally distributed level
+void gen_patterns(const MMN_GEN_PARAMS& params, std::vector<MMN_GEN_PATTERN>& patterns, \
+	std::vector<double>& patterns_weight)
+{
+	std::mt19937_64 rng(params.m_seed);
+	std::poisson_distribution<std::size_t> pattern_len(std::max(params.m_pattern_len - 1.0f, .0));
+	std::exponential_distribution<double> fraction(1.0f / std::max(params.m_correlation, 1e-6));
+	std::exponential_distribution<double> weight(1.0f);
+	std::normal_distribution<double> corruption(params.m_corruption, .1f);
+	std::uniform_int_distribution<std::uint32_t> item(0, \
+		static_cast<std::uint32_t>(params.m_items - 1));
+
+	patterns.resize(params.m_patterns);
+	patterns_weight.resize(params.m_patterns);
+
+	double weight_sum = .0f;
+	for (std::size_t pp = 0; pp < params.m_patterns; pp++)
+	{
+		MMN_GEN_PATTERN& pattern = patterns[pp];
+		std::size_t len = std::min(params.m_items, 1 + pattern_len(rng));
+
+		if (pp > 0L)
+		{
+			const std::vector<std::uint32_t>& prev = patterns[pp - 1].m_items;
+			std::size_t shared = std::min({ len, prev.size(), \
+				static_cast<std::size_t>(fraction(rng) * len + .5f) });
+
+			pattern.m_items = prev;
+			std::shuffle(pattern.m_items.begin(), pattern.m_items.end(), rng);
+			pattern.m_items.resize(shared);
+		}
+
+		while (pattern.m_items.size() < len) {
+			std::uint32_t item_id = item(rng);
+			if (std::find(pattern.m_items.begin(), pattern.m_items.end(), item_id) == pattern.m_items.end())
+				pattern.m_items.push_back(item_id);
+		}
+
+		std::sort(pattern.m_items.begin(), pattern.m_items.end());
+		// capped, so that every pattern still contributes items now and then
+		pattern.m_corruption = std::min(g_gen_max_corruption, std::max(.0, corruption(rng)));
+
+		weight_sum += (patterns_weight[pp] = weight(rng));
+	}
+
+	// cumulative weights, for picking patterns by a binary search
+	for (std::size_t pp = 0; pp < params.m_patterns; pp++)
+		patterns_weight[pp] = (pp > 0 ? patterns_weight[pp - 1] : .0f) + patterns_weight[pp] / weight_sum;
+}
+
+// fills transactions of Poisson-distributed length with corrupted patterns; a pattern that
+// does not fit is kept in the transaction half of the time and moved to the next otherwise
+void gen_block(const MMN_GEN_PARAMS& params, const std::vector<MMN_GEN_PATTERN>& patterns, \
+	const std::vector<double>& patterns_weight, const std::size_t block, \
+	const std::size_t trans_first, const std::size_t trans_last, std::string& block_buf)
+{
+	std::seed_seq block_seed{ params.m_seed, std::uint64_t(block) + 1 };
+	std::mt19937_64 rng(block_seed);
+
+	std::poisson_distribution<std::size_t> trans_len(std::max(params.m_trans_len - 1.0f, .0));
+	std::uniform_real_distribution<double> uniform(.0f, 1.0f);
+
+	std::vector<std::uint32_t> trans, pending;
+	char number_buf[16];
+
+	block_buf.clear();
+	for (std::size_t tt = trans_first; tt < trans_last; tt++)
+	{
+		std::size_t len = 1 + trans_len(rng);
+
+		trans.assign(pending.begin(), pending.end());
+		pending.clear();
+
+		while (trans.size() < len)
+		{
+			std::size_t pp = std::upper_bound(patterns_weight.begin(), \
+				patterns_weight.end(), uniform(rng)) - patterns_weight.begin();
+			const MMN_GEN_PATTERN& pattern = patterns[std::min(pp, patterns.size() - 1)];
+
+			std::vector<std::uint32_t> items(pattern.m_items);
+			while ((items.empty() == false) && (uniform(rng) < pattern.m_corruption))
+				items.erase(items.begin() + (rng() % items.size()));
+
+			if ((trans.size() + items.size() > len) && (trans.empty() == false) && (uniform(rng) < .5f)) {
+				pending.assign(items.begin(), items.end());
+				break;
+			}
+
+			trans.insert(trans.end(), items.begin(), items.end());
+		}
+
+		std::sort(trans.begin(), trans.end());
+		trans.erase(std::unique(trans.begin(), trans.end()), trans.end());
+
+		for (std::size_t jj = 0; jj < trans.size(); jj++)
+		{
+			block_buf.append("item", 4);
+			char* number_end = std::to_chars(number_buf, number_buf + sizeof(number_buf), trans[jj]).ptr;
+			block_buf.append(number_buf, number_end - number_buf);
+			block_buf.push_back((jj + 1 < trans.size()) ? ',' : '\n');
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	MMN_GEN_PARAMS params = { 1000000L, 10000L, 10.0f, 2000L, 4.0f, .5f, .5f, 1L };
+	const char* filename = nullptr;
+
+	// -n <transactions> -i <items> -t <average transaction length> -p <patterns>
+	// -l <average pattern length> -c <correlation> -x <corruption> -s <seed> -o <file>
+	for (int ii = 1; ii < argc - 1; ii += 2) {
+		std::string arg(argv[ii]);
+		if (arg == "-n") params.m_trans = std::strtoull(argv[ii + 1], nullptr, 10);
+		else if (arg == "-i") params.m_items = std::strtoull(argv[ii + 1], nullptr, 10);
+		else if (arg == "-t") params.m_trans_len = std::strtod(argv[ii + 1], nullptr);
+		else if (arg == "-p") params.m_patterns = std::strtoull(argv[ii + 1], nullptr, 10);
+		else if (arg == "-l") params.m_pattern_len = std::strtod(argv[ii + 1], nullptr);
+		else if (arg == "-c") params.m_correlation = std::strtod(argv[ii + 1], nullptr);
+		else if (arg == "-x") params.m_corruption = std::strtod(argv[ii + 1], nullptr);
+		else if (arg == "-s") params.m_seed = std::strtoull(argv[ii + 1], nullptr, 10);
+		else if (arg == "-o") filename = argv[ii + 1];
+	}
+
+	if ((filename == nullptr) || (params.m_items == 0L) || (params.m_patterns == 0L)) {
+		std::cerr << "Usage: intel_max_miner_gen -o <file> [-n transactions] [-i items] [-t length]" \
+			" [-p patterns] [-l pattern length] [-c correlation] [-x corruption] [-s seed]\n";
+		return 1;
+	}
+
+	std::FILE* file = std::fopen(filename, "wb");
+	if (file == nullptr) {
+		std::cerr << "Unable to write file: " << filename << "\n";
+		return 1;
+	}
+
+	std::vector<MMN_GEN_PATTERN> patterns;
+	std::vector<double> patterns_weight;
+	gen_patterns(params, patterns, patterns_weight);
+
+	// batches of blocks are generated in parallel and written in order
+	std::size_t blocks = (params.m_trans + g_gen_block_trans - 1) / g_gen_block_trans;
+	std::vector<std::string> blocks_buf(g_gen_batch_blocks);
+	for (std::size_t batch = 0; batch < blocks; batch += g_gen_batch_blocks)
+	{
+		std::size_t batch_last = std::min(blocks, batch + g_gen_batch_blocks);
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(batch, batch_last), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t bb = r.begin(); bb != r.end(); bb++)
+					gen_block(params, patterns, patterns_weight, bb, bb * g_gen_block_trans, \
+						std::min(params.m_trans, (bb + 1) * g_gen_block_trans), blocks_buf[bb - batch]);
+			});
+
+		for (std::size_t bb = batch; bb < batch_last; bb++)
+			std::fwrite(blocks_buf[bb - batch].data(), 1, blocks_buf[bb - batch].size(), file);
+	}
+
+	std::fclose(file);
+
+	return 0;
+}
@@ -1,57 +1,159 @@
-//==============================================================
-// Copyright  2020 Intel Corporation
-//
-// SPDX-License-Identifier: MIT
-// =============================================================
-
-#include <tbb/blocked_range.h>
-#include <tbb/global_control.h>
-#include <tbb/parallel_for.h>
-#include "tbb/task_group.h"
-
-#include <CL/sycl.hpp>
-
-#include <iomanip>
-#include <iostream>
-#include <algorithm>
-
-#include "main.hpp"
-
-using namespace cl::sycl;
-
-int main(int argc, char** argv)
-{
-	// C:\Users\arthu\Desktop\intel_omp_max_miner_exe\datasets\micro200.csv
-
-	static char filename[266] = "\0";
-
-	std::cout << "Parallel Max-Miner Algorithm by Arthur V. Ratz @ Intel DevMesh\n\n";
-
-	std::cout << "Enter filename: "; std::cin >> filename;
-
-	std::size_t rules_size = 0L;
-	MMN_RULE* rules_buf = nullptr;
-	MMN_TRANS_CONTEXT* trans_ctx = nullptr;
-	mm_model model(USM_ALLOC_TYPE::usm_alloc_crt);
-	model.load_trans_from_file(filename, trans_ctx);
-
-	std::cout << "\nTransactions:\t" << trans_ctx->m_stats.m_trans_cnt;
-	std::cout << "\nTransaction Len(Min):\t" << trans_ctx->m_stats.m_trans_min_len;
-	std::cout << "\nTransaction Len(Max):\t" << trans_ctx->m_stats.m_trans_max_len;
-	std::cout << "\n\nItems:\t" << trans_ctx->m_stats.m_items_cnt;
-	std::cout << "\nItem Len(Max):\t" << trans_ctx->m_stats.m_item_max_len << "\n\n";
-
-	sycl_usm_alloc_helper usm_alloc("");
-
-	parallel_max_miner::compute(trans_ctx, rules_buf, rules_size);
-
-	std::cout << "\n===========================================================\n";
-	std::cout << "Results:";
-	std::cout << "\n===========================================================\n\n";
-
-	parallel_max_miner::print_rules(rules_buf, rules_size);
-
-	std::cin.get();
-
-	return 0;
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#include <tbb/blocked_range.h>
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+#include "tbb/task_group.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#include "main.hpp"
+
+int main(int argc, char** argv)
+{
+	// C:\Users\arthu\Desktop\intel_omp_max_miner_exe\datasets\micro200.csv
+
+	static char filename[266] = "\0";
+
+	std::cout << "Parallel Max-Miner Algorithm by Arthur V. Ratz @ Intel DevMesh\n\n";
+
+	std::cout << "Enter filename: "; std::cin >> filename;
+
+	// -m <MiB> mines the file in blocks that fit the memory budget instead of loading it whole,
+	// -c <file> writes a binary cache of the parsed file, which can be given as the input later on,
+	// -t <threads> overrides the thread count detected from the affinity mask and cgroup quota,
+	// -p <file> profiles the run and writes its phase timings and level counters as JSON,
+	// -e <file> writes the same report with the hardware counters of every phase (linux only),
+	// -u <crt|host|shared> places the transactions in CRT memory or in USM of the run's queue,
+	// -i <min_supp> maintains the maximal itemsets at a relative minimum support incrementally,
+	// -a <file> appends the transactions of a file to the incremental run (may be repeated)
+	std::size_t mem_budget = 0L;
+	const char* cache_filename = nullptr;
+	const char* profile_filename = nullptr;
+	bool perf_counters = false;
+	double incremental_supp = .0f;
+	std::vector<const char*> append_filenames;
+	USM_ALLOC_TYPE alloc_type = USM_ALLOC_TYPE::usm_alloc_crt;
+	for (int ii = 1; ii < argc - 1; ii++) {
+		if (std::string(argv[ii]) == "-m")
+			mem_budget = std::strtoull(argv[ii + 1], nullptr, 10) << 20;
+		if (std::string(argv[ii]) == "-c")
+			cache_filename = argv[ii + 1];
+		if (std::string(argv[ii]) == "-t")
+			mm_topology::set_threads(std::strtoull(argv[ii + 1], nullptr, 10));
+		if (std::string(argv[ii]) == "-p")
+			profile_filename = argv[ii + 1];
+		if (std::string(argv[ii]) == "-e")
+			profile_filename = argv[ii + 1], perf_counters = true;
+		if (std::string(argv[ii]) == "-i")
+			incremental_supp = std::strtod(argv[ii + 1], nullptr);
+		if (std::string(argv[ii]) == "-a")
+			append_filenames.push_back(argv[ii + 1]);
+		if (std::string(argv[ii]) == "-u") {
+			if (std::string(argv[ii + 1]) == "host")
+				alloc_type = USM_ALLOC_TYPE::usm_alloc_host;
+			else if (std::string(argv[ii + 1]) == "shared")
+				alloc_type = USM_ALLOC_TYPE::usm_alloc_shared;
+			else if (std::string(argv[ii + 1]) != "crt") {
+				// the transactions are parsed and reduced on the host, so device memory does not fit them
+				std::cerr << "Error: (main) unsupported allocation type: " << argv[ii + 1] << "\n";
+				return 1;
+			}
+		}
+	}
+
+	// a streamed file is never held as one context, so there is nothing to cache
+	if ((mem_budget > 0L) && (cache_filename != nullptr)) {
+		std::cerr << "Error: (main) -c cannot be combined with -m\n";
+		return 1;
+	}
+
+	// the incremental run keeps the tid lists of every transaction, so it cannot stay within a budget
+	if ((mem_budget > 0L) && (incremental_supp > .0f)) {
+		std::cerr << "Error: (main) -i cannot be combined with -m\n";
+		return 1;
+	}
+
+	mm_profile::enable(profile_filename != nullptr);
+	if ((perf_counters == true) && (mm_perf::enable() == false))
+		std::cerr << "Error: (mm_perf) hardware counters are not available, profiling without them\n";
+
+	std::size_t rules_size = 0L;
+	MMN_RULE* rules_buf = nullptr;
+	MMN_TRANS_CONTEXT* trans_ctx = nullptr;
+	mm_model model(alloc_type);
+
+	// the items of a streamed cache point into its mapping, so the reader is kept to the end
+	MMN_TRANS_CONTEXT stream_ctx = {};
+	std::unique_ptr<mm_stream_reader> stream;
+	if (mem_budget > 0L)
+	{
+		stream.reset(new mm_stream_reader(filename, mem_budget, model));
+		parallel_max_miner::compute(*stream, stream_ctx, rules_buf, rules_size);
+		trans_ctx = &stream_ctx;
+	}
+
+	else {
+		model.load_trans_from_file(filename, trans_ctx);
+		if (cache_filename != nullptr)
+			mm_model::save_trans_to_cache(cache_filename, trans_ctx);
+	}
+
+	std::cout << "\nTransactions:\t" << trans_ctx->m_stats.m_trans_cnt;
+	std::cout << "\nTransaction Len(Min):\t" << trans_ctx->m_stats.m_trans_min_len;
+	std::cout << "\nTransaction Len(Max):\t" << trans_ctx->m_stats.m_trans_max_len;
+	std::cout << "\n\nItems:\t" << trans_ctx->m_stats.m_items_cnt;
+	std::cout << "\nItem Len(Max):\t" << trans_ctx->m_stats.m_item_max_len << "\n\n";
+
+	sycl_usm_alloc_helper usm_alloc("");
+
+	// the appended files share the model's item dictionary, so the latest context names every item
+	std::unique_ptr<mm_incremental> incremental;
+	if (incremental_supp > .0f)
+	{
+		incremental.reset(new mm_incremental(incremental_supp));
+		incremental->append(trans_ctx);
+
+		for (const char* append_filename : append_filenames) {
+			MMN_TRANS_CONTEXT* batch_ctx = nullptr;
+			model.load_trans_from_file(append_filename, batch_ctx);
+			incremental->append(batch_ctx);
+			trans_ctx = batch_ctx;
+		}
+
+		incremental->get_rules(rules_buf, rules_size);
+	}
+
+	else if (mem_budget == 0L)
+		parallel_max_miner::compute(trans_ctx, rules_buf, rules_size);
+
+	std::cout << "\n===========================================================\n";
+	std::cout << "Results:";
+	std::cout << "\n===========================================================\n\n";
+
+	parallel_max_miner::print_rules(rules_buf, rules_size, trans_ctx);
+
+	if (incremental != nullptr)
+		std::cout << "\nTransactions:\t" << incremental->trans() \
+			<< "\nNegative Border:\t" << incremental->border().size() << "\n";
+
+	if (profile_filename != nullptr) {
+		std::ofstream profile_file(profile_filename);
+		mm_profile::write_report(profile_file);
+	}
+
+	std::cin.get();
+
+	return 0;
 }
\ No newline at end of file
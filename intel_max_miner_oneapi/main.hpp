@@ -1,527 +1,1592 @@
-//==============================================================
-// Copyright  2020 Intel Corporation
-//
-// SPDX-License-Identifier: MIT
-// =============================================================
-
-#pragma once
-
-#include "mm_sort.hpp"
-#include "mm_vector.hpp"
-#include "usm_alloc.hpp"
-#include "mm_model.hpp"
-
-typedef std::pair<double, double> minmax_conf_type;
-typedef std::pair<std::size_t, std::size_t> trans_range_type;
-
-namespace parallel_max_miner
-{
-	void print_rules(const MMN_RULE* rules_buf, const std::size_t rules)
-	{
-		for (std::size_t i = 0; i < rules; i++)
-			std::cout << (i + 1) << " --> " << mm_vector::to_string(rules_buf[i].m_v, \
-				rules_buf[i].m_items) << "[ size = " << rules_buf[i].m_items << " conf = " << rules_buf[i].m_conf << " ]\n";
-	}
-
-	double get_mean_conf(const minmax_conf_type minmax_conf) {
-		return (minmax_conf.second - minmax_conf.first) * .5f;
-	}
-
-	minmax_conf_type get_minmax_conf(\
-		const MMN_RULE* cnds_buf, const std::size_t cnds)
-	{
-		double conf_min = .0f, conf_max = conf_min;
-
-		auto min_supp_it = std::min_element(cnds_buf, cnds_buf + cnds, \
-			[&](const MMN_RULE& rule1, const MMN_RULE& rule2) {
-				return (rule1.m_supp_ab < rule2.m_supp_ab);
-			});
-
-		conf_min = min_supp_it->m_supp_ab;
-
-		auto max_supp_it = std::max_element(cnds_buf, cnds_buf + cnds, \
-			[&](const MMN_RULE& rule1, const MMN_RULE& rule2) {
-				return (rule1.m_supp_ab < rule2.m_supp_ab);
-			});
-
-		conf_max = max_supp_it->m_supp_ab;
-
-
-		return std::make_pair<double, double>(double(conf_min), double(conf_max));
-	}
-
-	double get_support(const MMN_RULE& rule, \
-		MMN_TRANS_CONTEXT* trans_ctx, trans_range_type trans_range)
-	{
-		double count = 0L;
-		for (std::size_t i = trans_range.first; i < trans_range.second; i++)
-			count += (mm_vector::intersect_vec(rule.m_v, rule.m_items, \
-				trans_ctx->m_trans[i].m_v, trans_ctx->m_trans[i].m_items) == rule.m_items);
-
-		return count;
-	}
-
-	template<class _Pred>
-	void filter_cands(MMN_RULE* cnds_buf, \
-		MMN_RULE*& cnds_new_buf, std::size_t& cnds_size, _Pred pred)
-	{
-		sycl_usm_alloc_helper \
-			usm_alloc("mm_cnds buffers");
-
-		std::size_t cnds_new = 0L;
-		MMN_RULE* cnds_buf_new = nullptr;
-		for (std::size_t ii = 0; ii < cnds_size; ii++)
-			if (pred(cnds_buf[ii]))
-			{
-				usm_alloc.realloc_buf_async<MMN_RULE>(\
-					cnds_buf_new, (cnds_new + 1));
-
-				cnds_buf_new[cnds_new++] = cnds_buf[ii];
-			}
-
-			else {
-				usm_alloc.free_items_buf(\
-					cnds_buf[ii].m_v, cnds_buf[ii].m_items);
-			}
-
-		cnds_size = cnds_new;
-		cnds_new_buf = cnds_buf_new;
-	}
-
-	template<class _Pred>
-	void filter_cands(MMN_RULE*& cnds_buf, std::size_t& cnds_size, _Pred pred) {
-		MMN_RULE* cnds_buf_new = nullptr;
-		filter_cands(cnds_buf, cnds_buf_new, cnds_size, pred);
-		cnds_buf = cnds_buf_new;
-	}
-
-	cl::sycl::event init_model(MMN_RULE*& cnds_buf, \
-		MMN_TRANS_CONTEXT* trans_ctx, std::size_t& cnds, \
-			minmax_conf_type& minmax_conf)
-	{
-		cl::sycl::event event;
-
-		sycl_usm_alloc_helper usm_alloc(\
-			"mm_candidate buffers");
-
-		usm_alloc.alloc_cnds_buf(cnds_buf, cnds, 1L, \
-			trans_ctx->m_stats.m_item_max_len);
-
-		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
-			[&](const tbb::blocked_range<std::size_t>& r) {
-				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
-				{
-					cnds_buf[ii].m_items = 1L;
-					cnds_buf[ii].m_supp_a = trans_ctx->m_stats.m_trans_cnt;
-					cnds_buf[ii].m_supp_b = .0f;
-
-					usm_string_helper::strcpy(cnds_buf[ii].m_v[0].m_buf, trans_ctx->m_stats.m_item_max_len, \
-						trans_ctx->m_items[ii].m_buf, trans_ctx->m_items[ii].m_size);
-
-					trans_range_type trans_range = \
-						std::make_pair(0, trans_ctx->m_stats.m_trans_cnt);
-
-					cnds_buf[ii].m_supp_ab = get_support(cnds_buf[ii], trans_ctx, trans_range);
-					cnds_buf[ii].m_conf = cnds_buf[ii].m_supp_ab / cnds_buf[ii].m_supp_a;
-				}
-			});
-
-		filter_cands(cnds_buf, cnds, [&](const MMN_RULE& rule) {
-			return (rule.m_supp_ab > 1L) && (rule.m_supp_ab < trans_ctx->m_stats.m_trans_cnt); });
-
-		if ((minmax_conf.first == .0f) && (minmax_conf.second == .0f))
-			minmax_conf = get_minmax_conf(cnds_buf, cnds);
-
-		return event;
-	}
-
-	cl::sycl::event gen_sub_nodes(MMN_RULE*& cnds_buf, \
-		MMN_TRANS_CONTEXT* trans_ctx, std::size_t& cnds, \
-		minmax_conf_type minmax_conf, trans_range_type trans_range, \
-			cl::sycl::event event, cl::sycl::queue device_queue)
-	{
-		cl::sycl::event event1;
-
-		std::size_t cnds_new = \
-			(std::size_t)std::pow((double)cnds, 2.0);
-
-		sycl_usm_alloc_helper usm_alloc(\
-			"mm_candidate buffers", USM_ALLOC_TYPE::usm_alloc_crt);
-
-		MMN_RULE* cnds_buf1 = nullptr;
-		usm_alloc.alloc_cnds_buf(cnds_buf1, cnds_new, \
-			trans_ctx->m_stats.m_trans_max_len, \
-			trans_ctx->m_stats.m_item_max_len);
-
-		cl::sycl::buffer<trans_range_type, 1> trans_rng_buf{ &trans_range, 1L };
-
-		event1 = device_queue.submit([&](cl::sycl::handler& cgh) { \
-			cgh.depends_on(event);
-		auto trans_rng_acc = trans_rng_buf.get_access<cl::sycl::access::mode::read>(cgh);
-		cgh.parallel_for(cl::sycl::nd_range<2>{ \
-			cl::sycl::range<2>{cnds, cnds}, cl::sycl::range<2>{1, 1}}, \
-			[=, cnds_ptr = &cnds_buf[0], cnds_ptr1 = &cnds_buf1[0]](cl::sycl::nd_item<2> item) {
-
-			cl::sycl::id<2> idx = item.get_global_id();
-			std::size_t i = static_cast<std::size_t>(idx[0]);
-			std::size_t j = static_cast<std::size_t>(idx[1]);
-			std::size_t cand_rule_id = item.get_global_linear_id();
-
-			if (j > i)
-			{
-				std::size_t isect_size = mm_vector::intersect_vec(cnds_ptr[i].m_v, \
-					cnds_ptr[i].m_items, cnds_ptr[j].m_v, cnds_ptr[j].m_items);
-
-				if ((isect_size > 0L) || ((cnds_ptr[i].m_items <= 2) && (cnds_ptr[j].m_items <= 2)))
-				{
-					cnds_ptr1[cand_rule_id].m_items = mm_vector::union_vec(cnds_ptr[i].m_v, cnds_ptr[i].m_items, \
-						cnds_ptr[j].m_v, cnds_ptr[j].m_items, cnds_ptr1[cand_rule_id].m_v);
-
-					cnds_ptr1[cand_rule_id].m_supp_ab = \
-						get_support(cnds_ptr1[cand_rule_id], trans_ctx, trans_rng_acc[0]);
-
-					cnds_ptr1[cand_rule_id].m_supp_a = cnds_ptr[i].m_supp_ab;
-					cnds_ptr1[cand_rule_id].m_supp_b = cnds_ptr[j].m_supp_ab;
-
-					double conf_ab = cnds_ptr1[cand_rule_id].m_supp_ab / cnds_ptr1[cand_rule_id].m_supp_a;
-					double conf_ba = cnds_ptr1[cand_rule_id].m_supp_ab / cnds_ptr1[cand_rule_id].m_supp_b;
-
-					cnds_ptr1[cand_rule_id].m_conf = std::max<double>(conf_ab, conf_ba);
-				}
-			}
-		});
-			});
-
-		device_queue.wait_and_throw();
-
-		filter_cands(cnds_buf1, cnds_new, [&](const MMN_RULE& rule) {
-			return (rule.m_items > 1L) && (rule.m_supp_ab > 1.0f) && \
-				(rule.m_supp_a > 1.0f) && (rule.m_supp_b > 1.0f); });
-
-		if (cnds_new > 0L)
-			minmax_conf = get_minmax_conf(cnds_buf1, cnds_new);
-
-		filter_cands(cnds_buf1, cnds_new, [&](const MMN_RULE& rule) {
-			return rule.m_supp_ab >= get_mean_conf(minmax_conf); });
-
-		usm_alloc.free_cnds_buf(cnds_buf, cnds);
-
-		usm_alloc.alloc_cnds_buf(cnds_buf, cnds_new, \
-			trans_ctx->m_stats.m_trans_max_len, \
-			trans_ctx->m_stats.m_item_max_len);
-
-		event1 = device_queue.submit([&](cl::sycl::handler& cgh) { \
-			cgh.depends_on(event1);
-		cgh.parallel_for(cl::sycl::range<2>{cnds_new, trans_ctx->m_stats.m_trans_max_len}, \
-			[=, cnds_ptr = &cnds_buf[0], cnds_ptr1 = &cnds_buf1[0]](cl::sycl::id<2> idx) {
-				std::size_t ii = static_cast<std::size_t>(idx[0]);
-				std::size_t jj = static_cast<std::size_t>(idx[1]);
-
-				if (jj < cnds_ptr[ii].m_items) 
-				{
-					cnds_ptr[ii].m_conf = cnds_ptr1[ii].m_conf;
-					cnds_ptr[ii].m_items = cnds_ptr1[ii].m_items;
-					cnds_ptr[ii].m_supp_a = cnds_ptr1[ii].m_supp_a;
-					cnds_ptr[ii].m_supp_b = cnds_ptr1[ii].m_supp_b;
-					cnds_ptr[ii].m_supp_ab = cnds_ptr1[ii].m_supp_ab;
-
-					usm_string_helper::strcpy(cnds_ptr[ii].m_v[jj].m_buf, \
-						cnds_ptr[ii].m_v[jj].m_size, cnds_ptr1[ii].m_v[jj].m_buf, cnds_ptr1[ii].m_v[jj].m_size);
-				}
-			});
-		});
-
-		device_queue.wait_and_throw();
-
-		cnds = cnds_new;
-
-		usm_alloc.free_cnds_buf(cnds_buf1, cnds_new);
-
-		return event1;
-	}
-
-	void update_model(MMN_RULE*& cnds_buf, \
-		std::size_t& cnds, minmax_conf_type& minmax_conf)
-	{
-		if ((cnds > 0L) && (cnds_buf != nullptr))
-		{
-			filter_cands(cnds_buf, cnds, [&](const MMN_RULE& rule) {
-				double conf = rule.m_supp_ab / rule.m_supp_a;
-				return (conf >= get_mean_conf(minmax_conf));
-			});
-
-			minmax_conf = get_minmax_conf(cnds_buf, cnds);
-		}
-	}
-
-	cl::sycl::event remove_subsets(MMN_RULE*& cnds_buf, std::size_t& cnds, \
-		cl::sycl::event event, cl::sycl::queue device_queue)
-	{
-		event = device_queue.submit([&](cl::sycl::handler& cgh) { \
-			cgh.depends_on(event);
-			cgh.parallel_for(cl::sycl::range<2>{cnds, cnds}, \
-				[=, cnds_ptr = &cnds_buf[0]](cl::sycl::id<2> idx) {
-
-			std::size_t ii = static_cast<std::size_t>(idx[0]);
-			std::size_t jj = static_cast<std::size_t>(idx[1]);
-
-			if ((jj > ii) && (cnds_ptr[ii].m_supp_ab != .0f))
-			{
-				if (cnds_buf[jj].m_items < cnds_buf[ii].m_items)
-				{
-					std::size_t isect_size = mm_vector::intersect_vec(cnds_buf[ii].m_v, \
-						cnds_buf[ii].m_items, cnds_buf[jj].m_v, cnds_buf[jj].m_items);
-
-					cnds_buf[jj].m_supp_ab = (isect_size != \
-						cnds_buf[jj].m_items) ? cnds_buf[jj].m_supp_ab : .0f;
-				}
-			}
-		});
-			});
-
-		device_queue.wait_and_throw();
-
-		filter_cands(cnds_buf, cnds, [&](const MMN_RULE& rule) {
-			return (rule.m_supp_ab != .0f); });
-
-		return event;
-	}
-
-	void remove_subsets(MMN_RULE*& cnds_buf, MMN_RULE* rules_buf, MMN_TRANS_CONTEXT* trans_ctx, \
-		std::size_t& cnds, std::size_t rules)
-	{
-		for (std::size_t ii = 0; ii < cnds; ii++)
-			if (cnds_buf[ii].m_supp_ab != .0f)
-			{
-				bool exists = false;
-				for (std::size_t jj = 0; jj < rules && !exists; jj++)
-				{
-					if (rules_buf[jj].m_items < cnds_buf[ii].m_items)
-					{
-						std::size_t isect_size = mm_vector::intersect_vec(cnds_buf[ii].m_v, \
-							cnds_buf[ii].m_items, rules_buf[jj].m_v, rules_buf[jj].m_items);
-
-						exists = isect_size == rules_buf[jj].m_items;
-					}
-				}
-
-				if (exists == true) {
-					cnds_buf[ii].m_supp_ab = .0f;
-				}
-			}
-
-		filter_cands(cnds_buf, cnds, [&](const MMN_RULE& rule) {
-			return (rule.m_supp_ab != .0f); });
-	}
-
-	cl::sycl::event remove_duplicates(MMN_RULE*& cnds_buf, std::size_t& cnds, \
-		cl::sycl::event event, cl::sycl::queue device_queue)
-	{
-		event = device_queue.submit([&](cl::sycl::handler& cgh) { \
-			cgh.depends_on(event);
-			cgh.parallel_for(cl::sycl::range<2>{cnds, cnds}, \
-				[=, cnds_ptr = &cnds_buf[0]](cl::sycl::id<2> idx) {
-
-				std::size_t ii = static_cast<std::size_t>(idx[0]);
-				std::size_t jj = static_cast<std::size_t>(idx[1]);
-
-				if ((jj > ii) && (cnds_ptr[ii].m_supp_ab != .0f))
-				{
-					std::size_t isect_size = mm_vector::intersect_vec(cnds_ptr[ii].m_v, \
-						cnds_ptr[ii].m_items, cnds_ptr[jj].m_v, cnds_ptr[jj].m_items);
-
-					cnds_ptr[jj].m_supp_ab = ((mm_vector::is_equal_vec(cnds_ptr[ii].m_v, \
-						cnds_ptr[ii].m_items, cnds_ptr[jj].m_v, cnds_ptr[jj].m_items) == false) && \
-						((cnds_ptr[ii].m_items < cnds_ptr[jj].m_items) || (isect_size != cnds_ptr[jj].m_items))) ? cnds_ptr[jj].m_supp_ab : .0f;
-				}
-
-			});
-		});
-
-		device_queue.wait_and_throw();
-
-		filter_cands(cnds_buf, cnds, [&](const MMN_RULE& rule) {
-			return (rule.m_supp_ab != .0f); });
-
-		return event;
-	}
-
-	cl::sycl::event compute(MMN_RULE*& cnds_buf, const std::size_t cnds, \
-		MMN_RULE*& rules_buf, std::size_t& rules_size, MMN_TRANS_CONTEXT* trans_ctx, \
-			minmax_conf_type& minmax_conf, trans_range_type trans_range, \
-			cl::sycl::event event, cl::sycl::queue device_queue)
-	{
-		sycl_usm_alloc_helper usm_alloc(\
-			"mm_candidate buffers", USM_ALLOC_TYPE::usm_alloc_crt);
-
-		std::size_t cnds_count = cnds;
-
-		MMN_RULE* cnds_buf2 = nullptr;
-
-		usm_alloc.alloc_cnds_buf(cnds_buf2, cnds_count, \
-			trans_ctx->m_stats.m_trans_max_len, \
-			trans_ctx->m_stats.m_item_max_len);
-
-		event = device_queue.submit([&](cl::sycl::handler& cgh) { \
-		cgh.depends_on(event);
-		cgh.parallel_for(cl::sycl::range<2>{cnds, trans_ctx->m_stats.m_trans_max_len}, \
-			[=, cnds_ptr = &cnds_buf[0], cnds_ptr2 = &cnds_buf2[0]](cl::sycl::id<2> idx) {
-			std::size_t ii = static_cast<std::size_t>(idx[0]);
-			std::size_t jj = static_cast<std::size_t>(idx[1]);
-
-			if (jj < cnds_ptr[ii].m_items)
-			{
-				cnds_ptr2[ii].m_conf = cnds_ptr[ii].m_conf;
-				cnds_ptr2[ii].m_items = cnds_ptr[ii].m_items;
-				cnds_ptr2[ii].m_supp_a = cnds_ptr[ii].m_supp_a;
-				cnds_ptr2[ii].m_supp_b = cnds_ptr[ii].m_supp_b;
-				cnds_ptr2[ii].m_supp_ab = cnds_ptr[ii].m_supp_ab;
-
-				usm_string_helper::strcpy(cnds_ptr2[ii].m_v[jj].m_buf, \
-					cnds_ptr2[ii].m_v[jj].m_size, cnds_ptr[ii].m_v[jj].m_buf, cnds_ptr[ii].m_v[jj].m_size);
-			}
-		});
-			});
-
-		device_queue.wait_and_throw();
-
-		for (std::size_t step = 0L; cnds_count > 0L; step++)
-		{
-			if (step > 0L) 
-			{
-				tbb::spin_mutex mutex;
-				std::size_t rules_count = 0L;
-				tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds_count), \
-					[&](const tbb::blocked_range<std::size_t>& r) {
-						for (std::size_t ii = r.begin(); ii != r.end(); ii++)
-						{
-							bool has_subset = false;
-							tbb::parallel_for(tbb::blocked_range<std::size_t>(ii + 1, cnds_count), \
-								[&](const tbb::blocked_range<std::size_t>& r) {
-									for (std::size_t jj = r.begin(); jj != r.end() && !has_subset; jj++)
-										has_subset = mm_vector::intersect_vec(cnds_buf2[ii].m_v, \
-											cnds_buf2[ii].m_items, cnds_buf2[jj].m_v, cnds_buf2[jj].m_items) > 0L;
-								});
-
-							if (has_subset == false)
-							{
-								bool exists = false;
-								tbb::parallel_for(tbb::blocked_range<std::size_t>(0, rules_size), \
-									[&](const tbb::blocked_range<std::size_t>& r) {
-										for (std::size_t tt = r.begin(); tt != r.end() && !exists; tt++)
-											exists = mm_vector::intersect_vec(rules_buf[tt].m_v, \
-												rules_buf[tt].m_items, cnds_buf2[ii].m_v, \
-												cnds_buf2[ii].m_items) == cnds_buf2[ii].m_items;
-									});
-
-								if (exists == false)
-								{
-									tbb::spin_mutex::scoped_lock lock(mutex);
-
-									usm_alloc.realloc_buf_async<MMN_RULE>(\
-										rules_buf, (rules_size + 1));
-
-									rules_buf[rules_size].m_v = nullptr;
-									rules_buf[rules_size].m_conf = cnds_buf2[ii].m_conf;
-									rules_buf[rules_size].m_items = cnds_buf2[ii].m_items;
-									rules_buf[rules_size].m_supp_a = cnds_buf2[ii].m_supp_a;
-									rules_buf[rules_size].m_supp_b = cnds_buf2[ii].m_supp_b;
-									rules_buf[rules_size].m_supp_ab = cnds_buf2[ii].m_supp_ab;
-
-									usm_alloc.alloc_items_buf(rules_buf[rules_size].m_v, \
-										cnds_buf2[ii].m_items, trans_ctx->m_stats.m_item_max_len);
-
-									for (std::size_t jj = 0; jj < rules_buf[rules_size].m_items; jj++)
-									{
-										rules_buf[rules_size].m_v[jj].m_size = \
-											cnds_buf2[ii].m_v[jj].m_size;
-
-										usm_string_helper::strcpy(rules_buf[rules_size].m_v[jj].m_buf, \
-											rules_buf[rules_size].m_v[jj].m_size, cnds_buf2[ii].m_v[jj].m_buf, cnds_buf2[ii].m_v[jj].m_size);
-									}
-
-									rules_size++; rules_count++;
-								}
-							}
-						}
-					});
-
-				if (rules_count == 0L) {
-					return event;
-				}
-			}
-
-			event = gen_sub_nodes(cnds_buf2, trans_ctx, \
-				cnds_count, minmax_conf, trans_range, event, device_queue);
-
-			std::sort(cnds_buf2, cnds_buf2 + cnds_count, \
-				[&](const MMN_RULE& r1, const MMN_RULE& r2) {
-					return r1.m_items > r2.m_items;
-				});
-
-			event = remove_duplicates(cnds_buf2, cnds_count, event, device_queue);
-			event = remove_subsets(cnds_buf2, cnds_count, event, device_queue);
-		}
-
-		std::sort(rules_buf, rules_buf + rules_size, \
-			[&](const MMN_RULE& r1, const MMN_RULE& r2) {
-				return r1.m_items > r2.m_items;
-			});
-
-		usm_alloc.free_cnds_buf(cnds_buf2, cnds);
-
-		return event;
-	}
-
-	void compute(MMN_TRANS_CONTEXT* trans_ctx, \
-		MMN_RULE*& rules_buf, std::size_t& rules_size)
-	{
-		cl::sycl::event event;
-
-		MMN_RULE* cnds_buf = nullptr;
-		std::size_t cnds_size = \
-			trans_ctx->m_stats.m_items_cnt;
-
-		minmax_conf_type minmax_conf;
-		parallel_max_miner::init_model(cnds_buf, \
-			trans_ctx, cnds_size, minmax_conf);
-
-		int nth = 36;
-		tbb::task_group tg;
-		auto mp = tbb::global_control::max_allowed_parallelism;
-		tbb::global_control gc(mp, nth);
-
-		std::size_t chunk_size = trans_ctx->m_stats.m_trans_cnt * 0.1f;
-		std::size_t chunks_n = static_cast<std::size_t>( \
-			std::ceil(trans_ctx->m_stats.m_trans_cnt / double(chunk_size)));
-
-		tg.run_and_wait([&]() {
-			tbb::spin_mutex mutex;
-			tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chunks_n), \
-				[&](const tbb::blocked_range<std::size_t>& r) {
-					for (std::size_t ii = r.begin(); ii != r.end(); ii++)
-					{
-						std::size_t xs = ii * chunk_size;
-						std::size_t xe = (ii + 1) * chunk_size;
-
-						if (xe > trans_ctx->m_stats.m_trans_cnt)
-							xe = trans_ctx->m_stats.m_trans_cnt;
-
-						cl::sycl::cpu_selector s{};
-						cl::sycl::queue device_queue(s);
-
-						trans_range_type trans_range = std::make_pair(xs, xe);
-						event = parallel_max_miner::compute(cnds_buf, cnds_size, rules_buf, \
-							rules_size, trans_ctx, minmax_conf, trans_range, event, device_queue);
-
-						if (rules_size > 0L) {
-							event = remove_duplicates(rules_buf, rules_size, event, device_queue);
-							event = remove_subsets(rules_buf, rules_size, event, device_queue);
-						}
-					}
-			});
-		});
-	}
-
-	MMN_TRANS_CONTEXT* m_trans_ctx;
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include "mm_sort.hpp"
+#include "mm_vector.hpp"
+#include "usm_alloc.hpp"
+#include "mm_model.hpp"
+#include "mm_bitmap.hpp"
+#include "mm_store.hpp"
+#include "mm_trie.hpp"
+#include "mm_reduce.hpp"
+#include "mm_stream.hpp"
+#include "mm_topology.hpp"
+#include "mm_profile.hpp"
+#include "mm_backend.hpp"
+#include "mm_incremental.hpp"
+
+typedef std::pair<double, double> minmax_conf_type;
+typedef std::pair<std::size_t, std::size_t> trans_range_type;
+
+constexpr std::size_t g_scan_block_size = 1024;
+constexpr std::size_t g_partitions = 10;
+constexpr std::size_t g_trans_tile_max = 256;
+
+namespace parallel_max_miner
+{
+	void print_rules(const MMN_RULE* rules_buf, \
+		const std::size_t rules, const MMN_TRANS_CONTEXT* trans_ctx)
+	{
+		for (std::size_t i = 0; i < rules; i++)
+			std::cout << (i + 1) << " --> " << mm_vector::to_string(rules_buf[i].m_v, \
+				rules_buf[i].m_items, trans_ctx->m_items) << "[ size = " << rules_buf[i].m_items << " conf = " << rules_buf[i].m_conf << " ]\n";
+	}
+
+	double get_mean_conf(const minmax_conf_type minmax_conf) {
+		return (minmax_conf.second - minmax_conf.first) * .5f;
+	}
+
+	minmax_conf_type get_minmax_conf(\
+		const MMN_RULE* cnds_buf, const std::size_t cnds)
+	{
+		double conf_min = .0f, conf_max = conf_min;
+
+		auto min_supp_it = std::min_element(cnds_buf, cnds_buf + cnds, \
+			[&](const MMN_RULE& rule1, const MMN_RULE& rule2) {
+				return (rule1.m_supp_ab < rule2.m_supp_ab);
+			});
+
+		conf_min = min_supp_it->m_supp_ab;
+
+		auto max_supp_it = std::max_element(cnds_buf, cnds_buf + cnds, \
+			[&](const MMN_RULE& rule1, const MMN_RULE& rule2) {
+				return (rule1.m_supp_ab < rule2.m_supp_ab);
+			});
+
+		conf_max = max_supp_it->m_supp_ab;
+
+
+		return std::make_pair<double, double>(double(conf_min), double(conf_max));
+	}
+
+	minmax_conf_type get_minmax_conf(const MMN_CNDS_STORE& cnds_store)
+	{
+		auto minmax_supp_it = std::minmax_element(cnds_store.m_supp_ab, \
+			cnds_store.m_supp_ab + cnds_store.m_cnds);
+
+		return std::make_pair(*minmax_supp_it.first, *minmax_supp_it.second);
+	}
+
+	double get_support(const MMN_ITEM_ID* items_buf, const std::size_t items, \
+		MMN_TRANS_CONTEXT* trans_ctx, trans_range_type trans_range)
+	{
+		if ((trans_ctx->m_tidsets != nullptr) && \
+			(items <= g_tidset_max_items)) {
+			return static_cast<double>(mm_bitmap::get_support(trans_ctx->m_tidsets, \
+				items_buf, items, trans_range.first, trans_range.second));
+		}
+
+		double count = 0L;
+		for (std::size_t i = trans_range.first; i < trans_range.second; i++)
+			if (mm_vector::contains_vec(items_buf, items, \
+				trans_ctx->m_trans[i].m_v, trans_ctx->m_trans[i].m_items) == true)
+				count += trans_ctx->m_trans[i].m_weight;
+
+		return count;
+	}
+
+	double get_support(const MMN_RULE& rule, \
+		MMN_TRANS_CONTEXT* trans_ctx, trans_range_type trans_range) {
+		return get_support(rule.m_v, rule.m_items, trans_ctx, trans_range);
+	}
+
+	// the weighted count of the transactions in the range
+	double get_weight(const MMN_TRANS_CONTEXT* trans_ctx, trans_range_type trans_range)
+	{
+		double weight = .0f;
+		for (std::size_t i = trans_range.first; i < trans_range.second; i++)
+			weight += trans_ctx->m_trans[i].m_weight;
+
+		return weight;
+	}
+
+	// turns per-candidate counts into exclusive offsets in place and returns the total
+	std::size_t exclusive_scan(std::vector<std::size_t>& offs)
+	{
+		return tbb::parallel_scan(tbb::blocked_range<std::size_t>(0, offs.size()), std::size_t(0), \
+			[&](const tbb::blocked_range<std::size_t>& r, std::size_t sum, bool is_final) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++) {
+					std::size_t value = offs[ii];
+					if (is_final == true) offs[ii] = sum;
+					sum += value;
+				}
+
+				return sum;
+			}, std::plus<std::size_t>());
+	}
+
+	std::size_t round_up(const std::size_t size, const std::size_t multiple) {
+		return ((size + multiple - 1) / multiple) * multiple;
+	}
+
+	// the device's work-group limit, capped and halved while the launch
+	// would leave compute units without a group
+	template<class _Backend>
+	std::size_t work_group_size(const _Backend& backend, const std::size_t items)
+	{
+		std::size_t wg_max = std::min<std::size_t>(\
+			g_work_group_max, backend.max_work_group_size());
+		std::size_t units = std::max<std::size_t>(1L, backend.compute_units());
+
+		std::size_t wg = std::max<std::size_t>(1L, wg_max);
+		while ((wg > 1L) && (items < wg * units)) wg /= 2;
+
+		return wg;
+	}
+
+	// the items of a transactions tile that fit in half of the device's local memory,
+	// next to the group's candidates and the tile's offsets and weights; none on a host backend
+	template<class _Backend>
+	std::size_t tile_items_size(const _Backend& backend, \
+		const std::size_t wg, const std::size_t cand_len)
+	{
+		std::size_t local_mem = backend.local_mem_size() / 2;
+		std::size_t fixed = wg * cand_len * sizeof(MMN_ITEM_ID) + \
+			(2 * g_trans_tile_max + 1) * sizeof(std::size_t);
+
+		return (local_mem > fixed) ? (local_mem - fixed) / sizeof(MMN_ITEM_ID) : 0L;
+	}
+
+#if defined(MM_BACKEND_SYCL)
+	// counts the supports of equal-length candidates by scanning the transactions: every
+	// work-group stages its candidates and then one tile of transactions after the other in
+	// local memory, so a transaction is read from global memory once per group; the tile
+	// bounds live in the caller's scratch arena, so the kernel is left running on return
+	cl::sycl::event count_tiled(const MMN_CNDS_STORE& cnds_store, \
+		MMN_TRANS_CONTEXT* trans_ctx, trans_range_type trans_range, \
+			const std::size_t wg, const std::size_t tile_items, \
+			cl::sycl::event event, mm_backend_sycl& backend, sycl_usm_arena& scratch_arena)
+	{
+		const std::size_t cnds = cnds_store.m_cnds;
+		const std::size_t cand_len = cnds_store.m_items[0];
+		const std::size_t trans = trans_range.second - trans_range.first;
+
+		sycl_usm_alloc_helper scratch_alloc(\
+			"mm_tile buffers", scratch_arena.alloc_type(), &scratch_arena);
+
+		std::size_t* trans_offs = nullptr;
+		std::size_t* tiles = nullptr;
+		scratch_alloc.alloc_buffer<std::size_t>(trans_offs, trans + 1);
+		scratch_alloc.alloc_buffer<std::size_t>(tiles, trans + 1);
+
+		// tiles end where either the transactions or the items of a tile run out
+		std::size_t tiles_n = 0L;
+		for (std::size_t tt = 0; tt < trans; tt++)
+		{
+			std::size_t len = trans_ctx->m_trans[trans_range.first + tt].m_items;
+			if ((tt - tiles[tiles_n] == g_trans_tile_max) || \
+				(trans_offs[tt] - trans_offs[tiles[tiles_n]] + len > tile_items))
+				tiles[++tiles_n] = tt;
+
+			trans_offs[tt + 1] = trans_offs[tt] + len;
+		}
+
+		tiles[++tiles_n] = trans;
+
+		event = backend.queue().submit([&](cl::sycl::handler& cgh) { \
+			cgh.depends_on(event);
+
+		cl::sycl::accessor<MMN_ITEM_ID, 1, cl::sycl::access::mode::read_write, \
+			cl::sycl::access::target::local> cnds_tile(cl::sycl::range<1>{ wg * cand_len }, cgh);
+		cl::sycl::accessor<MMN_ITEM_ID, 1, cl::sycl::access::mode::read_write, \
+			cl::sycl::access::target::local> trans_tile(cl::sycl::range<1>{ tile_items }, cgh);
+		cl::sycl::accessor<std::size_t, 1, cl::sycl::access::mode::read_write, \
+			cl::sycl::access::target::local> trans_tile_offs(cl::sycl::range<1>{ g_trans_tile_max + 1 }, cgh);
+		cl::sycl::accessor<std::size_t, 1, cl::sycl::access::mode::read_write, \
+			cl::sycl::access::target::local> trans_tile_weight(cl::sycl::range<1>{ g_trans_tile_max }, cgh);
+
+		cgh.parallel_for(cl::sycl::nd_range<1>{ round_up(cnds, wg), wg }, \
+			[=, cnds_s = cnds_store, trans_buf = trans_ctx->m_trans + trans_range.first, \
+				offs_ptr = trans_offs, tiles_ptr = tiles](cl::sycl::nd_item<1> it) {
+
+			std::size_t ii = it.get_global_id(0);
+			std::size_t lid = it.get_local_id(0);
+
+			// the work-items past the last candidate still take part in the staging
+			const bool is_active = (ii < cnds);
+
+			MMN_ITEM_ID* cand_v = &cnds_tile[lid * cand_len];
+			for (std::size_t tt = 0; is_active && (tt < cand_len); tt++)
+				cand_v[tt] = cnds_s.m_pool[cnds_s.m_offs[ii] + tt];
+
+			double supp_ab = .0f;
+			for (std::size_t tl = 0; tl < tiles_n; tl++)
+			{
+				std::size_t t_first = tiles_ptr[tl], t_last = tiles_ptr[tl + 1];
+				for (std::size_t tt = t_first + lid; tt < t_last; tt += wg)
+				{
+					std::size_t tile_offs = offs_ptr[tt] - offs_ptr[t_first];
+					for (std::size_t jj = 0; jj < trans_buf[tt].m_items; jj++)
+						trans_tile[tile_offs + jj] = trans_buf[tt].m_v[jj];
+
+					trans_tile_offs[tt - t_first] = tile_offs;
+					trans_tile_weight[tt - t_first] = trans_buf[tt].m_weight;
+				}
+
+				if (lid == 0L)
+					trans_tile_offs[t_last - t_first] = offs_ptr[t_last] - offs_ptr[t_first];
+
+				it.barrier(cl::sycl::access::fence_space::local_space);
+
+				for (std::size_t tt = 0; is_active && (tt < t_last - t_first); tt++)
+					if (mm_vector::contains_vec(cand_v, cand_len, &trans_tile[trans_tile_offs[tt]], \
+						trans_tile_offs[tt + 1] - trans_tile_offs[tt]) == true)
+						supp_ab += trans_tile_weight[tt];
+
+				it.barrier(cl::sycl::access::fence_space::local_space);
+			}
+
+			if (is_active == true) {
+				cnds_s.m_supp_ab[ii] = supp_ab;
+				cnds_s.m_conf[ii] = std::max<double>(\
+					supp_ab / cnds_s.m_supp_a[ii], supp_ab / cnds_s.m_supp_b[ii]);
+			}
+		});
+			});
+
+		return event;
+	}
+#endif
+
+	template<class _Pred>
+	void filter_cands(MMN_RULE* cnds_buf, \
+		MMN_RULE*& cnds_new_buf, std::size_t& cnds_size, _Pred pred, \
+			sycl_usm_arena* arena = nullptr)
+	{
+		mm_profile::scope_timer timer("filter_cands");
+
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_cnds buffers", USM_ALLOC_TYPE::usm_alloc_crt, arena);
+
+		// the trailing zero turns into the survivors count
+		std::vector<std::size_t> cnds_offs(cnds_size + 1, 0L);
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds_size), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+					cnds_offs[ii] = pred(cnds_buf[ii]) ? 1L : 0L;
+			});
+
+		std::size_t cnds_new = exclusive_scan(cnds_offs);
+
+		MMN_RULE* cnds_buf_new = nullptr;
+		usm_alloc.alloc_buffer<MMN_RULE>(cnds_buf_new, \
+			(arena != nullptr) ? cnds_new : usm_alloc.grow_capacity(cnds_new));
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds_size), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+					if (cnds_offs[ii + 1] != cnds_offs[ii])
+						cnds_buf_new[cnds_offs[ii]] = cnds_buf[ii];
+
+					else {
+						usm_alloc.free_buffer<MMN_ITEM_ID>(cnds_buf[ii].m_v);
+					}
+			});
+
+		cnds_size = cnds_new;
+		cnds_new_buf = cnds_buf_new;
+	}
+
+	template<class _Pred>
+	void filter_cands(MMN_RULE*& cnds_buf, std::size_t& cnds_size, \
+		_Pred pred, sycl_usm_arena* arena = nullptr)
+	{
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_cnds buffers", USM_ALLOC_TYPE::usm_alloc_crt, arena);
+
+		MMN_RULE* cnds_buf_new = nullptr;
+		filter_cands(cnds_buf, cnds_buf_new, cnds_size, pred, arena);
+		usm_alloc.free_buffer<MMN_RULE>(cnds_buf);
+		cnds_buf = cnds_buf_new;
+	}
+
+	template<class _Pred>
+	void filter_cands(const MMN_CNDS_STORE& cnds_store, \
+		MMN_CNDS_STORE& cnds_new_store, _Pred pred, sycl_usm_arena* arena = nullptr)
+	{
+		mm_profile::scope_timer timer("filter_cands");
+
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_cnds buffers", USM_ALLOC_TYPE::usm_alloc_crt, arena);
+
+		std::vector<std::size_t> cnds_offs(cnds_store.m_cnds + 1, 0L);
+		std::vector<std::size_t> pool_offs(cnds_store.m_cnds + 1, 0L);
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds_store.m_cnds), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+					if (pred(cnds_store, ii)) {
+						cnds_offs[ii] = 1L; pool_offs[ii] = cnds_store.m_items[ii];
+					}
+			});
+
+		std::size_t cnds_new = exclusive_scan(cnds_offs);
+		std::size_t pool_size = exclusive_scan(pool_offs);
+
+		MMN_CNDS_STORE cnds_store_new = {};
+		usm_alloc.alloc_cnds_store(cnds_store_new, cnds_new, pool_size);
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds_store.m_cnds), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+					if (cnds_offs[ii + 1] != cnds_offs[ii])
+						mm_store::copy_cnd(cnds_store, ii, \
+							cnds_store_new, cnds_offs[ii], pool_offs[ii]);
+			});
+
+		cnds_new_store = cnds_store_new;
+	}
+
+	template<class _Pred>
+	void filter_cands(MMN_CNDS_STORE& cnds_store, \
+		_Pred pred, sycl_usm_arena* arena = nullptr)
+	{
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_cnds buffers", USM_ALLOC_TYPE::usm_alloc_crt, arena);
+
+		MMN_CNDS_STORE cnds_store_new = {};
+		filter_cands(cnds_store, cnds_store_new, pred, arena);
+		usm_alloc.free_cnds_store(cnds_store);
+		cnds_store = cnds_store_new;
+	}
+
+	// the same compaction as a chain of kernels on the caller's backend: each work-item
+	// evaluates and counts one block, a single task scans the block counts, and each
+	// work-item then scatters its block's survivors from the block's output offset;
+	// the keep flags stay on the device, the block counts are shared with the host,
+	// which sizes the output from them
+	template<class _Backend, class _Pred>
+	typename _Backend::event_type filter_cands(const MMN_CNDS_STORE& cnds_store, \
+		MMN_CNDS_STORE& cnds_new_store, _Pred pred, typename _Backend::event_type event, \
+			_Backend& backend, sycl_usm_arena* arena = nullptr)
+	{
+		mm_profile::scope_timer timer("filter_cands");
+
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_cnds buffers", USM_ALLOC_TYPE::usm_alloc_crt, arena);
+		sycl_usm_alloc_helper keep_alloc(\
+			"mm_scan buffers", _Backend::device_alloc);
+		sycl_usm_alloc_helper scan_alloc(\
+			"mm_scan buffers", _Backend::shared_alloc);
+
+		cnds_new_store = MMN_CNDS_STORE{};
+
+		const std::size_t cnds = cnds_store.m_cnds;
+		const std::size_t blocks = (cnds + g_scan_block_size - 1) / g_scan_block_size;
+
+		if (cnds == 0L) return event;
+
+		const std::size_t wg = work_group_size(backend, blocks);
+
+		bool* cnds_keep = nullptr;
+		std::size_t* block_cnds = nullptr;
+		std::size_t* block_pool = nullptr;
+		keep_alloc.alloc_buffer<bool>(cnds_keep, cnds);
+		scan_alloc.alloc_buffer<std::size_t>(block_cnds, blocks + 1);
+		scan_alloc.alloc_buffer<std::size_t>(block_pool, blocks + 1);
+
+		event = backend.parallel_for(round_up(blocks, wg), wg, event, \
+			[=](typename _Backend::item_type it) {
+			std::size_t bb = it.get_global_id(0);
+			if (bb >= blocks) return;
+
+			std::size_t ii_last = std::min<std::size_t>((bb + 1) * g_scan_block_size, cnds);
+
+			std::size_t cnt = 0L, pool = 0L;
+			for (std::size_t ii = bb * g_scan_block_size; ii < ii_last; ii++)
+				if ((cnds_keep[ii] = pred(cnds_store, ii)) == true) {
+					cnt++; pool += cnds_store.m_items[ii];
+				}
+
+			block_cnds[bb] = cnt; block_pool[bb] = pool;
+		});
+
+		event = backend.single_task(event, [=]() {
+			std::size_t cnt = 0L, pool = 0L;
+			for (std::size_t bb = 0; bb <= blocks; bb++) {
+				std::size_t block_cnt = block_cnds[bb], block_pl = block_pool[bb];
+				block_cnds[bb] = cnt; block_pool[bb] = pool;
+				cnt += block_cnt; pool += block_pl;
+			}
+		});
+
+		event.wait_and_throw();
+
+		MMN_CNDS_STORE cnds_store_new = {};
+		usm_alloc.alloc_cnds_store(cnds_store_new, block_cnds[blocks], block_pool[blocks]);
+
+		event = backend.parallel_for(round_up(blocks, wg), wg, event, \
+			[=, cnds_dst = cnds_store_new](typename _Backend::item_type it) {
+			std::size_t bb = it.get_global_id(0);
+			if (bb >= blocks) return;
+
+			std::size_t ii_last = std::min<std::size_t>((bb + 1) * g_scan_block_size, cnds);
+
+			std::size_t jj = block_cnds[bb], pool_offs = block_pool[bb];
+			for (std::size_t ii = bb * g_scan_block_size; ii < ii_last; ii++)
+				if (cnds_keep[ii] == true) {
+					mm_store::copy_cnd(cnds_store, ii, cnds_dst, jj++, pool_offs);
+					pool_offs += cnds_store.m_items[ii];
+				}
+		});
+
+		event.wait_and_throw();
+
+		keep_alloc.free_buffer<bool>(cnds_keep);
+		scan_alloc.free_buffer<std::size_t>(block_cnds);
+		scan_alloc.free_buffer<std::size_t>(block_pool);
+
+		cnds_new_store = cnds_store_new;
+
+		return event;
+	}
+
+	template<class _Backend, class _Pred>
+	typename _Backend::event_type filter_cands(MMN_CNDS_STORE& cnds_store, _Pred pred, \
+		typename _Backend::event_type event, _Backend& backend, sycl_usm_arena* arena = nullptr)
+	{
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_cnds buffers", USM_ALLOC_TYPE::usm_alloc_crt, arena);
+
+		MMN_CNDS_STORE cnds_store_new = {};
+		event = filter_cands(cnds_store, cnds_store_new, pred, event, backend, arena);
+		usm_alloc.free_cnds_store(cnds_store);
+		cnds_store = cnds_store_new;
+
+		return event;
+	}
+
+	void init_model(MMN_RULE*& cnds_buf, \
+		MMN_TRANS_CONTEXT* trans_ctx, std::size_t& cnds, \
+			minmax_conf_type& minmax_conf)
+	{
+		mm_profile::scope_timer timer("init_model");
+
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_candidate buffers");
+
+		usm_alloc.alloc_cnds_buf(cnds_buf, cnds, 1L);
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+				{
+					cnds_buf[ii].m_items = 1L;
+					cnds_buf[ii].m_supp_a = trans_ctx->m_stats.m_trans_cnt;
+					cnds_buf[ii].m_supp_b = .0f;
+
+					cnds_buf[ii].m_v[0] = static_cast<MMN_ITEM_ID>(ii);
+
+					trans_range_type trans_range = \
+						std::make_pair(0, trans_ctx->m_stats.m_trans_cnt);
+
+					cnds_buf[ii].m_supp_ab = get_support(cnds_buf[ii], trans_ctx, trans_range);
+					cnds_buf[ii].m_conf = cnds_buf[ii].m_supp_ab / cnds_buf[ii].m_supp_a;
+				}
+			});
+
+		filter_cands(cnds_buf, cnds, [&](const MMN_RULE& rule) {
+			return (rule.m_supp_ab > 1L) && (rule.m_supp_ab < trans_ctx->m_stats.m_trans_cnt); });
+
+		if ((minmax_conf.first == .0f) && (minmax_conf.second == .0f))
+			minmax_conf = get_minmax_conf(cnds_buf, cnds);
+	}
+
+	// the same first level, built from item supports that were counted block by block
+	void init_model(MMN_RULE*& cnds_buf, const std::vector<double>& items_supp, \
+		const std::size_t trans, std::size_t& cnds, minmax_conf_type& minmax_conf)
+	{
+		mm_profile::scope_timer timer("init_model");
+
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_candidate buffers");
+
+		cnds = items_supp.size();
+		usm_alloc.alloc_cnds_buf(cnds_buf, cnds, 1L);
+
+		for (std::size_t ii = 0; ii < cnds; ii++)
+		{
+			cnds_buf[ii].m_items = 1L;
+			cnds_buf[ii].m_supp_a = static_cast<double>(trans);
+			cnds_buf[ii].m_supp_b = .0f;
+
+			cnds_buf[ii].m_v[0] = static_cast<MMN_ITEM_ID>(ii);
+
+			cnds_buf[ii].m_supp_ab = items_supp[ii];
+			cnds_buf[ii].m_conf = cnds_buf[ii].m_supp_ab / cnds_buf[ii].m_supp_a;
+		}
+
+		filter_cands(cnds_buf, cnds, [&](const MMN_RULE& rule) {
+			return (rule.m_supp_ab > 1L) && (rule.m_supp_ab < trans); });
+
+		if ((cnds > 0L) && (minmax_conf.first == .0f) && (minmax_conf.second == .0f))
+			minmax_conf = get_minmax_conf(cnds_buf, cnds);
+	}
+
+	// joins every candidate with the later candidates of its (k-1)-prefix class and applies
+	// the Max-Miner lookahead: a candidate (head) with at least two join partners also has
+	// its head-and-tail set counted, where the tail holds the partners' last items; when that set
+	// is frequent it covers all of the head's descendants, so it is reported into
+	// cnds_max_store instead of expanding the head's children; a candidate is frequent when
+	// its support over the range reaches min_supp
+	template<class _Backend>
+	typename _Backend::event_type gen_sub_nodes(const MMN_CNDS_STORE& cnds_store, \
+		MMN_CNDS_STORE& cnds_new_store, MMN_CNDS_STORE& cnds_max_store, \
+		MMN_TRANS_CONTEXT* trans_ctx, const mm_itemset_trie* maximal_trie, \
+		const double min_supp, trans_range_type trans_range, \
+			typename _Backend::event_type event, _Backend& backend, \
+			sycl_usm_arena& level_arena, sycl_usm_arena& scratch_arena)
+	{
+		mm_profile::scope_timer timer("gen_sub_nodes", \
+			(cnds_store.m_cnds > 0L) ? cnds_store.m_items[0] + 1 : 0L);
+
+		typename _Backend::event_type event1;
+
+		sycl_usm_alloc_helper scratch_alloc(\
+			"mm_candidate buffers", USM_ALLOC_TYPE::usm_alloc_crt, &scratch_arena);
+
+		cnds_new_store = MMN_CNDS_STORE{};
+		cnds_max_store = MMN_CNDS_STORE{};
+
+		const std::size_t cnds = cnds_store.m_cnds;
+		if ((cnds == 0L) || (cnds_store.m_items[0] >= trans_ctx->m_stats.m_trans_max_len))
+			return event;
+
+		// candidates hold their items in search order, the head's items followed by the item
+		// that extended it, and the children of one head are contiguous, so a candidate's
+		// join partners are the following candidates that share all but its last item; the
+		// offsets are read by the kernels below, so they live in the scratch arena
+		std::size_t* joins_offs = nullptr;
+		scratch_alloc.alloc_buffer<std::size_t>(joins_offs, cnds + 1);
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+				{
+					std::size_t jj = ii + 1;
+					while ((jj < cnds) && (cnds_store.m_items[jj] == cnds_store.m_items[ii]) && \
+						mm_vector::is_equal_vec(mm_store::items(cnds_store, ii), cnds_store.m_items[ii] - 1, \
+							mm_store::items(cnds_store, jj), cnds_store.m_items[jj] - 1)) jj++;
+
+					joins_offs[ii + 1] = jj - ii - 1;
+				}
+			});
+
+		for (std::size_t ii = 0; ii < cnds; ii++)
+			joins_offs[ii + 1] += joins_offs[ii];
+
+		std::size_t joins = joins_offs[cnds];
+		std::size_t join_len = cnds_store.m_items[0] + 1;
+
+		if (joins == 0L) return event;
+
+		MMN_CNDS_STORE cnds_store1 = {};
+		scratch_alloc.alloc_cnds_store(cnds_store1, joins, joins * join_len);
+
+		// the head-and-tail set of i starts at (join_len - 1) * i + joins_offs[i] in the lookahead pool
+		MMN_CNDS_STORE cnds_ht_store = {};
+		scratch_alloc.alloc_cnds_store(cnds_ht_store, cnds, cnds * (join_len - 1) + joins);
+
+		std::size_t* cnds_parent = nullptr;
+		scratch_alloc.alloc_buffer<std::size_t>(cnds_parent, joins);
+
+		// candidates are counted against the transactions by the tiled kernel when they are
+		// too long for the tidset index and the longest transaction fits a tile
+		const bool use_tidsets = (trans_ctx->m_tidsets != nullptr) && \
+			(join_len <= g_tidset_max_items);
+
+		const std::size_t wg_joins = work_group_size(backend, joins);
+		const std::size_t tile_items = tile_items_size(backend, wg_joins, join_len);
+		const bool use_tiles = (use_tidsets == false) && \
+			(tile_items >= trans_ctx->m_stats.m_trans_max_len);
+
+		// one work-item per joined pair (i, j > i) of a prefix class, so only the upper
+		// triangle of every class is visited
+		event1 = backend.parallel_for(round_up(joins, wg_joins), wg_joins, event, \
+			[=, cnds_src = cnds_store, cnds_dst = cnds_store1, \
+				offs_ptr = joins_offs](typename _Backend::item_type it) {
+
+			std::size_t cand_rule_id = it.get_global_id(0);
+			if (cand_rule_id >= joins) return;
+
+			// the head is the candidate whose joins range holds this pair
+			std::size_t i_first = 0L, i_last = cnds;
+			while (i_last - i_first > 1L) {
+				std::size_t i_mid = (i_first + i_last) / 2;
+				if (offs_ptr[i_mid] <= cand_rule_id) i_first = i_mid;
+				else i_last = i_mid;
+			}
+
+			std::size_t i = i_first;
+			std::size_t j = i + 1 + (cand_rule_id - offs_ptr[i]);
+
+			const MMN_ITEM_ID* items_i = cnds_src.m_pool + cnds_src.m_offs[i];
+
+			MMN_ITEM_ID* cand_v = cnds_dst.m_pool + cand_rule_id * join_len;
+			for (std::size_t tt = 0; tt < join_len - 1; tt++)
+				cand_v[tt] = items_i[tt];
+
+			cand_v[join_len - 1] = cnds_src.m_pool[cnds_src.m_offs[j] + join_len - 2];
+
+			cnds_dst.m_offs[cand_rule_id] = cand_rule_id * join_len;
+			cnds_dst.m_items[cand_rule_id] = join_len;
+			cnds_parent[cand_rule_id] = i;
+
+			cnds_dst.m_supp_a[cand_rule_id] = cnds_src.m_supp_ab[i];
+			cnds_dst.m_supp_b[cand_rule_id] = cnds_src.m_supp_ab[j];
+
+			if (use_tiles == false) {
+				double supp_ab = get_support(cand_v, join_len, trans_ctx, trans_range);
+				cnds_dst.m_supp_ab[cand_rule_id] = supp_ab;
+				cnds_dst.m_conf[cand_rule_id] = std::max<double>(\
+					supp_ab / cnds_src.m_supp_ab[i], supp_ab / cnds_src.m_supp_ab[j]);
+			}
+		});
+
+#if defined(MM_BACKEND_SYCL)
+		if constexpr (std::is_same<_Backend, mm_backend_sycl>::value) {
+			if (use_tiles == true) {
+				event1 = count_tiled(cnds_store1, trans_ctx, trans_range, \
+					wg_joins, tile_items, event1, backend, scratch_arena);
+			}
+		}
+#endif
+
+		// the head-and-tail set of every head with at least two join partners
+		const std::size_t wg_heads = work_group_size(backend, cnds);
+		event1 = backend.parallel_for(round_up(cnds, wg_heads), wg_heads, event1, \
+			[=, cnds_src = cnds_store, cnds_ht = cnds_ht_store, \
+				offs_ptr = joins_offs](typename _Backend::item_type it) {
+
+			std::size_t i = it.get_global_id(0);
+			if (i >= cnds) return;
+
+			std::size_t joins_i = offs_ptr[i + 1] - offs_ptr[i];
+			const MMN_ITEM_ID* items_i = cnds_src.m_pool + cnds_src.m_offs[i];
+
+			// the tail is the partners' last items in their (support-ranked) order
+			MMN_ITEM_ID* ht_v = cnds_ht.m_pool + (join_len - 1) * i + offs_ptr[i];
+			for (std::size_t tt = 0; tt < join_len - 1; tt++)
+				ht_v[tt] = items_i[tt];
+			for (std::size_t j = i + 1; j <= i + joins_i; j++)
+				ht_v[join_len - 2 + (j - i)] = cnds_src.m_pool[cnds_src.m_offs[j] + join_len - 2];
+
+			cnds_ht.m_offs[i] = (join_len - 1) * i + offs_ptr[i];
+			cnds_ht.m_items[i] = join_len - 1 + joins_i;
+			cnds_ht.m_supp_a[i] = cnds_src.m_supp_ab[i];
+			cnds_ht.m_supp_b[i] = cnds_src.m_supp_ab[i];
+
+			cnds_ht.m_supp_ab[i] = (joins_i > 1L) ? \
+				get_support(ht_v, join_len - 1 + joins_i, trans_ctx, trans_range) : .0f;
+			cnds_ht.m_conf[i] = cnds_ht.m_supp_ab[i] / cnds_src.m_supp_ab[i];
+		});
+
+		event1.wait_and_throw();
+
+		// Max-Miner's dynamic reordering: the children of every head, which form the next
+		// level's join classes, are ranked by ascending conditional support
+		MMN_CNDS_STORE cnds_store1r = {};
+		scratch_alloc.alloc_cnds_store(cnds_store1r, joins, joins * join_len);
+
+		std::size_t* cnds_parent_r = nullptr;
+		scratch_alloc.alloc_buffer<std::size_t>(cnds_parent_r, joins);
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				std::vector<std::size_t> cnds_order;
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+				{
+					cnds_order.resize(joins_offs[ii + 1] - joins_offs[ii]);
+					for (std::size_t jj = 0; jj < cnds_order.size(); jj++)
+						cnds_order[jj] = joins_offs[ii] + jj;
+
+					std::stable_sort(cnds_order.begin(), cnds_order.end(), \
+						[&](const std::size_t c1, const std::size_t c2) {
+							return cnds_store1.m_supp_ab[c1] < cnds_store1.m_supp_ab[c2];
+						});
+
+					for (std::size_t jj = 0; jj < cnds_order.size(); jj++) {
+						std::size_t cand_rule_id = joins_offs[ii] + jj;
+						mm_store::copy_cnd(cnds_store1, cnds_order[jj], \
+							cnds_store1r, cand_rule_id, cand_rule_id * join_len);
+						cnds_parent_r[cand_rule_id] = cnds_parent[cnds_order[jj]];
+					}
+				}
+			});
+
+		cnds_store1 = cnds_store1r;
+		cnds_parent = cnds_parent_r;
+
+		// the threshold does not change from level to level, so every subset of a frequent
+		// candidate is frequent as well
+		auto is_frequent = [=](const MMN_CNDS_STORE& cnds_s, std::size_t ii) {
+			return (cnds_s.m_supp_ab[ii] > .0f) && (cnds_s.m_supp_ab[ii] >= min_supp);
+		};
+
+		// a head is covered when its head-and-tail set is frequent at this level, or when a known
+		// maximal itemset already contains it; only the former is reported
+		bool* cnds_covered = nullptr;
+		bool* cnds_report = nullptr;
+		scratch_alloc.alloc_buffer<bool>(cnds_covered, cnds);
+		scratch_alloc.alloc_buffer<bool>(cnds_report, cnds);
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				std::vector<MMN_ITEM_ID> items_ii;
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+				{
+					if ((joins_offs[ii + 1] - joins_offs[ii]) < 2L) continue;
+
+					mm_store::sorted_items(cnds_ht_store, ii, items_ii);
+					bool is_known = (maximal_trie != nullptr) && \
+						maximal_trie->has_superset(items_ii.data(), items_ii.size());
+
+					cnds_report[ii] = (is_known == false) && is_frequent(cnds_ht_store, ii);
+					cnds_covered[ii] = (is_known == true) || (cnds_report[ii] == true);
+				}
+			});
+
+		event1 = filter_cands(cnds_ht_store, cnds_max_store, [=](const MMN_CNDS_STORE&, std::size_t ii) {
+			return cnds_report[ii]; }, event1, backend, &level_arena);
+
+		// the surviving children are compacted straight into the next level's arena
+		event1 = filter_cands(cnds_store1, cnds_new_store, [=](const MMN_CNDS_STORE& cnds_s, std::size_t ii) {
+			return is_frequent(cnds_s, ii) && \
+				(cnds_covered[cnds_parent[ii]] == false); }, event1, backend, &level_arena);
+
+		if (mm_profile::enabled() == true)
+		{
+			MMN_PROFILE_LEVEL counters = {};
+			counters.m_generated = joins;
+			for (std::size_t ii = 0; ii < joins; ii++)
+				counters.m_frequent += is_frequent(cnds_store1, ii);
+
+			counters.m_uncovered = cnds_new_store.m_cnds;
+			counters.m_lookahead = cnds_max_store.m_cnds;
+
+			// every join and every head with two or more partners is counted once
+			counters.m_support_evals = joins;
+			for (std::size_t ii = 0; ii < cnds; ii++)
+				counters.m_support_evals += ((joins_offs[ii + 1] - joins_offs[ii]) > 1L);
+
+			counters.m_trans_scanned = counters.m_support_evals * \
+				(trans_range.second - trans_range.first);
+
+			mm_profile::add_level(join_len, counters);
+		}
+
+		scratch_arena.reset();
+
+		return event1;
+	}
+
+	void update_model(MMN_RULE*& cnds_buf, \
+		std::size_t& cnds, minmax_conf_type& minmax_conf)
+	{
+		if ((cnds > 0L) && (cnds_buf != nullptr))
+		{
+			filter_cands(cnds_buf, cnds, [&](const MMN_RULE& rule) {
+				double conf = rule.m_supp_ab / rule.m_supp_a;
+				return (conf >= get_mean_conf(minmax_conf));
+			});
+
+			minmax_conf = get_minmax_conf(cnds_buf, cnds);
+		}
+	}
+
+	// keeps the maximal itemsets only: walking from the largest itemsets down, an
+	// itemset is dropped when the trie of the itemsets kept so far has a superset of it;
+	// itemsets of one size are ordered by their items, so the order does not depend on
+	// the partition that found them
+	void remove_subsets(MMN_RULE*& cnds_buf, std::size_t& cnds, sycl_usm_arena* arena = nullptr)
+	{
+		mm_profile::scope_timer timer("remove_subsets");
+
+		std::stable_sort(cnds_buf, cnds_buf + cnds, \
+			[&](const MMN_RULE& r1, const MMN_RULE& r2) {
+				if (r1.m_items != r2.m_items)
+					return r1.m_items > r2.m_items;
+
+				return mm_vector::compare_vec(r1.m_v, r1.m_items, r2.m_v, r2.m_items) < 0;
+			});
+
+		mm_itemset_trie maximal_trie;
+		for (std::size_t ii = 0; ii < cnds; ii++)
+			if (maximal_trie.has_superset(cnds_buf[ii].m_v, cnds_buf[ii].m_items) == false)
+				maximal_trie.insert(cnds_buf[ii].m_v, cnds_buf[ii].m_items);
+
+			else {
+				cnds_buf[ii].m_supp_ab = .0f;
+			}
+
+		filter_cands(cnds_buf, cnds, [&](const MMN_RULE& rule) {
+			return (rule.m_supp_ab != .0f); }, arena);
+	}
+
+	void remove_subsets(MMN_RULE*& cnds_buf, MMN_RULE* rules_buf, MMN_TRANS_CONTEXT* trans_ctx, \
+		std::size_t& cnds, std::size_t rules)
+	{
+		mm_profile::scope_timer timer("remove_subsets");
+
+		mm_itemset_trie rules_trie;
+		for (std::size_t jj = 0; jj < rules; jj++)
+			rules_trie.insert(rules_buf[jj].m_v, rules_buf[jj].m_items);
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+					if ((cnds_buf[ii].m_supp_ab != .0f) && \
+						(rules_trie.has_subset(cnds_buf[ii].m_v, cnds_buf[ii].m_items) == true))
+						cnds_buf[ii].m_supp_ab = .0f;
+			});
+
+		filter_cands(cnds_buf, cnds, [&](const MMN_RULE& rule) {
+			return (rule.m_supp_ab != .0f); });
+	}
+
+	// keeps the first occurrence of every itemset: each itemset is looked up by its
+	// canonical hash, and its table entry holds the lowest index seen with it
+	void remove_duplicates(MMN_RULE*& cnds_buf, std::size_t& cnds, sycl_usm_arena* arena = nullptr)
+	{
+		mm_profile::scope_timer timer("remove_duplicates");
+
+		std::vector<std::uint64_t> cnds_hash(cnds, 0L);
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+					cnds_hash[ii] = mm_vector::hash_vec(cnds_buf[ii].m_v, cnds_buf[ii].m_items);
+			});
+
+		struct cnds_hash_compare {
+			const MMN_RULE* m_cnds_buf;
+			const std::uint64_t* m_cnds_hash;
+
+			std::size_t hash(const std::size_t ii) const {
+				return static_cast<std::size_t>(m_cnds_hash[ii]);
+			}
+
+			bool equal(const std::size_t ii, const std::size_t jj) const {
+				return (m_cnds_hash[ii] == m_cnds_hash[jj]) && \
+					mm_vector::is_equal_vec(m_cnds_buf[ii].m_v, m_cnds_buf[ii].m_items, \
+						m_cnds_buf[jj].m_v, m_cnds_buf[jj].m_items);
+			}
+		};
+
+		typedef tbb::concurrent_hash_map<std::size_t, \
+			std::size_t, cnds_hash_compare> cnds_hash_map;
+
+		cnds_hash_map cnds_first(cnds, cnds_hash_compare{ cnds_buf, cnds_hash.data() });
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+				{
+					cnds_hash_map::accessor acc;
+					if (cnds_first.insert(acc, ii) == true)
+						acc->second = ii;
+					else acc->second = std::min(acc->second, ii);
+				}
+			});
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+				{
+					cnds_hash_map::const_accessor acc;
+					if ((cnds_first.find(acc, ii) == true) && (acc->second != ii))
+						cnds_buf[ii].m_supp_ab = .0f;
+				}
+			});
+
+		filter_cands(cnds_buf, cnds, [&](const MMN_RULE& rule) {
+			return (rule.m_supp_ab != .0f); }, arena);
+	}
+
+	// appends the itemsets of a level that are neither contained in a surviving candidate
+	// of the next level nor in an already accepted rule
+	void emit_rules(const MMN_CNDS_STORE& cnds_store, const mm_itemset_trie& cnds_trie, \
+		mm_itemset_trie& rules_trie, MMN_RULE*& rules_buf, std::size_t& rules_size)
+	{
+		sycl_usm_alloc_helper rules_alloc(\
+			"mm_rule buffers", USM_ALLOC_TYPE::usm_alloc_crt);
+
+		std::vector<bool> cnds_emit(cnds_store.m_cnds, false);
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds_store.m_cnds), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				std::vector<MMN_ITEM_ID> items_ii;
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+				{
+					mm_store::sorted_items(cnds_store, ii, items_ii);
+					cnds_emit[ii] = \
+						(cnds_trie.has_superset(items_ii.data(), items_ii.size()) == false) && \
+						(rules_trie.has_superset(items_ii.data(), items_ii.size()) == false);
+				}
+			});
+
+		std::vector<MMN_ITEM_ID> items_ii;
+		for (std::size_t ii = 0; ii < cnds_store.m_cnds; ii++)
+			if (cnds_emit[ii] == true)
+			{
+				// an earlier itemset of the same call may already cover this one
+				mm_store::sorted_items(cnds_store, ii, items_ii);
+				if (rules_trie.has_superset(items_ii.data(), items_ii.size()) == true)
+					continue;
+
+				rules_alloc.realloc_buf_grow<MMN_RULE>(\
+					rules_buf, rules_size);
+
+				rules_buf[rules_size].m_v = nullptr;
+				rules_buf[rules_size].m_conf = cnds_store.m_conf[ii];
+				rules_buf[rules_size].m_items = cnds_store.m_items[ii];
+				rules_buf[rules_size].m_supp_a = cnds_store.m_supp_a[ii];
+				rules_buf[rules_size].m_supp_b = cnds_store.m_supp_b[ii];
+				rules_buf[rules_size].m_supp_ab = cnds_store.m_supp_ab[ii];
+
+				rules_alloc.alloc_buffer<MMN_ITEM_ID>(\
+					rules_buf[rules_size].m_v, cnds_store.m_items[ii]);
+
+				std::memcpy(rules_buf[rules_size].m_v, items_ii.data(), \
+					cnds_store.m_items[ii] * sizeof(MMN_ITEM_ID));
+
+				// in search order the parents leave out the last and the second-to-last item,
+				// whose positions move when the items are sorted
+				const MMN_ITEM_ID* items_cnd = mm_store::items(cnds_store, ii);
+				if (cnds_store.m_items[ii] >= 2L) {
+					rules_buf[rules_size].m_parent_a = std::lower_bound(items_ii.begin(), \
+						items_ii.end(), items_cnd[cnds_store.m_items[ii] - 1]) - items_ii.begin();
+					rules_buf[rules_size].m_parent_b = std::lower_bound(items_ii.begin(), \
+						items_ii.end(), items_cnd[cnds_store.m_items[ii] - 2]) - items_ii.begin();
+				}
+
+				rules_trie.insert(rules_buf[rules_size].m_v, rules_buf[rules_size].m_items);
+
+				rules_size++;
+			}
+	}
+
+	template<class _Backend>
+	typename _Backend::event_type compute(MMN_RULE*& cnds_buf, const std::size_t cnds, \
+		MMN_RULE*& rules_buf, std::size_t& rules_size, MMN_TRANS_CONTEXT* trans_ctx, \
+			const double min_supp, trans_range_type trans_range, \
+			typename _Backend::event_type event, _Backend& backend)
+	{
+		// the levels and the scratch buffers are read by the kernels, so a SYCL run places
+		// them in shared USM of its queue
+		sycl_usm_arena level_arena("mm_level buffers", g_arena_slab_size, _Backend::shared_alloc);
+		sycl_usm_arena next_arena("mm_level buffers", g_arena_slab_size, _Backend::shared_alloc);
+		sycl_usm_arena scratch_arena("mm_scratch buffers", g_arena_slab_size, _Backend::shared_alloc);
+
+		// level k lives in one arena while level k+1 is built in the other
+		sycl_usm_arena* level_ptr = &level_arena;
+		sycl_usm_arena* next_ptr = &next_arena;
+
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_candidate buffers", USM_ALLOC_TYPE::usm_alloc_crt, &level_arena);
+
+		mm_itemset_trie rules_trie;
+		for (std::size_t tt = 0; tt < rules_size; tt++)
+			rules_trie.insert(rules_buf[tt].m_v, rules_buf[tt].m_items);
+
+		// the first level is taken over from the AoS candidates of init_model
+		MMN_CNDS_STORE cnds_store2 = {};
+		usm_alloc.alloc_cnds_store(cnds_store2, cnds, mm_store::pool_size(cnds_buf, cnds));
+		mm_store::from_rules(cnds_buf, cnds, cnds_store2);
+
+		for (std::size_t step = 0L; cnds_store2.m_cnds > 0L; step++)
+		{
+			MMN_CNDS_STORE cnds_store3 = {};
+			MMN_CNDS_STORE cnds_max_store = {};
+
+			std::size_t level = cnds_store2.m_items[0] + 1;
+			event = gen_sub_nodes(cnds_store2, cnds_store3, cnds_max_store, trans_ctx, &rules_trie, \
+				min_supp, trans_range, event, backend, *next_ptr, scratch_arena);
+
+			{
+				mm_profile::scope_timer timer("emit_rules", level);
+
+				mm_itemset_trie cnds_trie;
+				std::vector<MMN_ITEM_ID> items_jj;
+				for (std::size_t jj = 0; jj < cnds_store3.m_cnds; jj++) {
+					mm_store::sorted_items(cnds_store3, jj, items_jj);
+					cnds_trie.insert(items_jj.data(), items_jj.size());
+				}
+
+				// lookahead sets cover their heads' subtrees and are reported right away
+				emit_rules(cnds_max_store, cnds_trie, rules_trie, rules_buf, rules_size);
+
+				// a k-itemset is maximal at this level when no surviving (k+1)-itemset contains it
+				if (step > 0L)
+					emit_rules(cnds_store2, cnds_trie, rules_trie, rules_buf, rules_size);
+			}
+
+			level_ptr->reset();
+			std::swap(level_ptr, next_ptr);
+
+			cnds_store2 = cnds_store3;
+		}
+
+		std::sort(rules_buf, rules_buf + rules_size, \
+			[&](const MMN_RULE& r1, const MMN_RULE& r2) {
+				return r1.m_items > r2.m_items;
+			});
+
+		return event;
+	}
+
+	void merge_rules(MMN_RULE*& rules_buf, std::size_t& rules_size, \
+		std::vector<MMN_RULE*>& chunk_rules, const std::vector<std::size_t>& chunk_rules_size)
+	{
+		sycl_usm_alloc_helper rules_alloc(\
+			"mm_rule buffers", USM_ALLOC_TYPE::usm_alloc_crt);
+
+		std::size_t rules_new = rules_size;
+		for (std::size_t ii = 0; ii < chunk_rules.size(); ii++)
+			rules_new += chunk_rules_size[ii];
+
+		if (rules_new > rules_size)
+			rules_alloc.realloc_buf_async<MMN_RULE>(rules_buf, \
+				rules_alloc.grow_capacity(rules_new), rules_size);
+
+		// the rule nodes keep their item buffers, only the node arrays are released
+		for (std::size_t ii = 0; ii < chunk_rules.size(); ii++) {
+			if (chunk_rules_size[ii] > 0L)
+				std::memcpy(rules_buf + rules_size, chunk_rules[ii], \
+					chunk_rules_size[ii] * sizeof(MMN_RULE));
+
+			rules_size += chunk_rules_size[ii];
+			rules_alloc.free_buffer<MMN_RULE>(chunk_rules[ii]);
+		}
+	}
+
+	// adds the supports of the itemset and of its two join parents over all transactions
+	// of the context; 1-item parents are left to update_conf, since a reduced context
+	// no longer holds the transactions with a single frequent item
+	void count_supports(MMN_RULE* rules_buf, \
+		const std::size_t rules_size, MMN_TRANS_CONTEXT* trans_ctx)
+	{
+		mm_profile::scope_timer timer("count_supports");
+
+		trans_range_type trans_range = \
+			std::make_pair(0, trans_ctx->m_stats.m_trans_cnt);
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, rules_size), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				std::vector<MMN_ITEM_ID> parent_a, parent_b;
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+				{
+					MMN_RULE& rule = rules_buf[ii];
+					rule.m_supp_ab += get_support(rule, trans_ctx, trans_range);
+					if (rule.m_items < 3L) continue;
+
+					parent_a.assign(rule.m_v, rule.m_v + rule.m_items);
+					parent_a.erase(parent_a.begin() + rule.m_parent_a);
+
+					parent_b.assign(rule.m_v, rule.m_v + rule.m_items);
+					parent_b.erase(parent_b.begin() + rule.m_parent_b);
+
+					rule.m_supp_a += get_support(parent_a.data(), parent_a.size(), trans_ctx, trans_range);
+					rule.m_supp_b += get_support(parent_b.data(), parent_b.size(), trans_ctx, trans_range);
+				}
+			});
+	}
+
+	void clear_supports(MMN_RULE* rules_buf, const std::size_t rules_size)
+	{
+		for (std::size_t ii = 0; ii < rules_size; ii++) {
+			rules_buf[ii].m_supp_ab = .0f;
+			if (rules_buf[ii].m_items < 2L) continue;
+			rules_buf[ii].m_supp_a = rules_buf[ii].m_supp_b = .0f;
+		}
+	}
+
+	// items_supp holds the supports of the items, which are the 1-item subsets of the pairs
+	void update_conf(MMN_RULE* rules_buf, const std::size_t rules_size, \
+		const std::vector<double>& items_supp)
+	{
+		for (std::size_t ii = 0; ii < rules_size; ii++) {
+			MMN_RULE& rule = rules_buf[ii];
+			if (rule.m_items < 2L) continue;
+			if (rule.m_items == 2L) {
+				rule.m_supp_a = items_supp[rule.m_v[1 - rule.m_parent_a]];
+				rule.m_supp_b = items_supp[rule.m_v[1 - rule.m_parent_b]];
+			}
+
+			rule.m_conf = std::max<double>(rule.m_supp_ab / rule.m_supp_a, \
+				rule.m_supp_ab / rule.m_supp_b);
+		}
+	}
+
+	// recounts the itemset and its two join parents over all transactions
+	void count_rules(MMN_RULE* rules_buf, const std::size_t rules_size, \
+		MMN_TRANS_CONTEXT* trans_ctx, const std::vector<double>& items_supp)
+	{
+		clear_supports(rules_buf, rules_size);
+		count_supports(rules_buf, rules_size, trans_ctx);
+		update_conf(rules_buf, rules_size, items_supp);
+	}
+
+	// the dynamic reordering of a partition follows its own supports, so the parents recorded
+	// by emit_rules depend on the partitioning; the recount takes the parents that the static
+	// order of the first level gives, which leave out the two items ranked last
+	void rank_parents(MMN_RULE* rules_buf, const std::size_t rules_size, \
+		const std::vector<std::size_t>& items_rank)
+	{
+		for (std::size_t ii = 0; ii < rules_size; ii++)
+		{
+			MMN_RULE& rule = rules_buf[ii];
+			if (rule.m_items < 2L) continue;
+
+			rule.m_parent_a = 0L; rule.m_parent_b = 1L;
+			if (items_rank[rule.m_v[0]] > items_rank[rule.m_v[1]])
+				std::swap(rule.m_parent_a, rule.m_parent_b);
+
+			for (std::size_t jj = 2; jj < rule.m_items; jj++)
+				if (items_rank[rule.m_v[jj]] > items_rank[rule.m_v[rule.m_parent_a]]) {
+					rule.m_parent_b = rule.m_parent_a; rule.m_parent_a = jj;
+				}
+
+				else if (items_rank[rule.m_v[jj]] > items_rank[rule.m_v[rule.m_parent_b]])
+					rule.m_parent_b = jj;
+		}
+	}
+
+	// phase one finds the itemsets that are maximal in some partition, and one of those may fall
+	// short of min_supp over all transactions while some of its subsets reach it; such itemsets
+	// are replaced by their frequent subsets of two or more items, one level down at a time,
+	// and count_sets recounts every level over all transactions
+	template<class _Count>
+	void shrink_rules(MMN_RULE*& rules_buf, std::size_t& rules_size, \
+		const double min_supp, _Count count_sets)
+	{
+		mm_profile::scope_timer timer("shrink_rules");
+
+		sycl_usm_alloc_helper rules_alloc(\
+			"mm_rule buffers", USM_ALLOC_TYPE::usm_alloc_crt);
+
+		auto is_frequent = [&](const MMN_RULE& rule) {
+			return (rule.m_supp_ab > 1.0f) && (rule.m_supp_ab >= min_supp); };
+
+		// a subset of a frequent itemset is not maximal, so it is never visited
+		mm_itemset_trie frequent_trie;
+		std::set<std::vector<MMN_ITEM_ID>> sets_visited;
+		std::vector<std::vector<MMN_ITEM_ID>> sets_infrequent;
+		for (std::size_t ii = 0; ii < rules_size; ii++)
+			if (is_frequent(rules_buf[ii]) == true)
+				frequent_trie.insert(rules_buf[ii].m_v, rules_buf[ii].m_items);
+
+			else if (rules_buf[ii].m_items > 2L) {
+				sets_infrequent.emplace_back(rules_buf[ii].m_v, \
+					rules_buf[ii].m_v + rules_buf[ii].m_items);
+				sets_visited.insert(sets_infrequent.back());
+			}
+
+		filter_cands(rules_buf, rules_size, is_frequent);
+
+		while (sets_infrequent.empty() == false)
+		{
+			std::vector<std::vector<MMN_ITEM_ID>> subsets;
+			for (const std::vector<MMN_ITEM_ID>& set : sets_infrequent)
+				for (std::size_t jj = 0; jj < set.size(); jj++)
+				{
+					std::vector<MMN_ITEM_ID> subset(set);
+					subset.erase(subset.begin() + jj);
+
+					if ((frequent_trie.has_superset(subset.data(), subset.size()) == false) && \
+						(sets_visited.insert(subset).second == true))
+						subsets.push_back(subset);
+				}
+
+			sets_infrequent.clear();
+			if (subsets.empty() == true) break;
+
+			MMN_RULE* sets_buf = nullptr;
+			std::size_t sets_size = subsets.size();
+			rules_alloc.alloc_buffer<MMN_RULE>(sets_buf, rules_alloc.grow_capacity(sets_size));
+
+			for (std::size_t ii = 0; ii < sets_size; ii++)
+			{
+				MMN_RULE& set = sets_buf[ii];
+				set.m_items = subsets[ii].size();
+
+				rules_alloc.alloc_buffer<MMN_ITEM_ID>(set.m_v, set.m_items);
+				std::memcpy(set.m_v, subsets[ii].data(), set.m_items * sizeof(MMN_ITEM_ID));
+			}
+
+			count_sets(sets_buf, sets_size);
+
+			for (std::size_t ii = 0; ii < sets_size; ii++)
+				if (is_frequent(sets_buf[ii]) == true)
+					frequent_trie.insert(sets_buf[ii].m_v, sets_buf[ii].m_items);
+
+				else if (sets_buf[ii].m_items > 2L)
+					sets_infrequent.push_back(subsets[ii]);
+
+			filter_cands(sets_buf, sets_size, is_frequent);
+			for (std::size_t ii = 0; ii < sets_size; ii++) {
+				rules_alloc.realloc_buf_grow<MMN_RULE>(rules_buf, rules_size);
+				rules_buf[rules_size++] = sets_buf[ii];
+			}
+
+			rules_alloc.free_buffer<MMN_RULE>(sets_buf);
+		}
+	}
+
+	// copies the transactions of a range into a context of their own, indexed like the source;
+	// the calling threads are the first to touch its pages
+	MMN_TRANS_CONTEXT* copy_partition(const MMN_TRANS_CONTEXT* trans_ctx, \
+		trans_range_type trans_range, const MMN_RULE* cnds_buf, const std::size_t cnds, \
+			sycl_usm_arena& arena)
+	{
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_partition buffers", USM_ALLOC_TYPE::usm_alloc_crt, &arena);
+
+		const std::size_t trans = trans_range.second - trans_range.first;
+
+		std::vector<std::size_t> trans_offs(trans + 1, 0L);
+		for (std::size_t tt = 0; tt < trans; tt++)
+			trans_offs[tt + 1] = trans_offs[tt] + trans_ctx->m_trans[trans_range.first + tt].m_items;
+
+		MMN_TRANS* trans_buf = nullptr;
+		MMN_ITEM_ID* trans_pool = nullptr;
+		usm_alloc.alloc_buffer<MMN_TRANS>(trans_buf, trans);
+		usm_alloc.alloc_buffer<MMN_ITEM_ID>(trans_pool, trans_offs[trans]);
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, trans), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t tt = r.begin(); tt != r.end(); tt++)
+				{
+					const MMN_TRANS& trans_src = trans_ctx->m_trans[trans_range.first + tt];
+					std::memcpy(trans_pool + trans_offs[tt], trans_src.m_v, \
+						trans_src.m_items * sizeof(MMN_ITEM_ID));
+
+					trans_buf[tt].m_v = trans_pool + trans_offs[tt];
+					trans_buf[tt].m_items = trans_src.m_items;
+					trans_buf[tt].m_weight = trans_src.m_weight;
+				}
+			});
+
+		MMN_TRANS_STATS stats = trans_ctx->m_stats;
+		stats.m_trans_cnt = trans;
+
+		MMN_TRANS_CONTEXT* partition_ctx = nullptr;
+		usm_alloc.alloc_trans_ctx(partition_ctx, trans_ctx->m_items, trans_buf, stats);
+		partition_ctx->m_trans_pool = trans_pool;
+
+		if (trans_ctx->m_tidsets != nullptr) {
+			mm_bitmap::build_index(partition_ctx->m_tidsets, \
+				partition_ctx, cnds_buf, cnds);
+		}
+
+		return partition_ctx;
+	}
+
+	// phase one of the partitioned search: every partition of the context mines its locally
+	// maximal itemsets into its own buffer, and the buffers are appended in partition order;
+	// min_supp applies to trans_weight transactions and is scaled to the partition's share,
+	// so an itemset that reaches min_supp overall reaches it in at least one partition
+	template<class _Backend>
+	void mine_partitions(MMN_RULE*& cnds_buf, const std::size_t cnds_size, \
+		MMN_TRANS_CONTEXT* trans_ctx, const double min_supp, const double trans_weight, \
+			MMN_RULE*& rules_buf, std::size_t& rules_size)
+	{
+		mm_profile::scope_timer timer("mine_partitions");
+
+		auto mp = tbb::global_control::max_allowed_parallelism;
+		tbb::global_control gc(mp, mm_topology::threads());
+
+		// ten balanced partitions, so no partition is left with a handful of transactions
+		std::size_t chunks_n = std::min<std::size_t>(\
+			g_partitions, trans_ctx->m_stats.m_trans_cnt);
+
+		std::vector<MMN_RULE*> chunk_rules(chunks_n, nullptr);
+		std::vector<std::size_t> chunk_rules_size(chunks_n, 0L);
+
+		// runs of consecutive partitions go to the NUMA nodes; with more than one node every
+		// partition is copied and indexed by its node's threads, so it is mined from local memory
+		std::vector<std::unique_ptr<tbb::task_arena>> arenas;
+		mm_topology::numa_arenas(arenas);
+
+		// the workers of the arenas are attached to the hardware counters as they join
+		std::vector<std::unique_ptr<mm_perf::arena_observer>> observers;
+		for (std::size_t nn = 0; (mm_perf::enabled() == true) && (nn < arenas.size()); nn++) {
+			observers.emplace_back(new mm_perf::arena_observer(*arenas[nn]));
+			observers.back()->observe(true);
+		}
+
+		const bool numa_local = (arenas.size() > 1L);
+
+		auto mine_partition = [&](const std::size_t ii) {
+			std::size_t xs = ii * trans_ctx->m_stats.m_trans_cnt / chunks_n;
+			std::size_t xe = (ii + 1) * trans_ctx->m_stats.m_trans_cnt / chunks_n;
+
+			// the partitions of a SYCL run share its queue and chain their own events on it
+			_Backend backend;
+
+			typename _Backend::event_type chunk_event;
+
+			trans_range_type trans_range = std::make_pair(xs, xe);
+			double chunk_min_supp = (trans_weight > .0f) ? \
+				min_supp * get_weight(trans_ctx, trans_range) / trans_weight : min_supp;
+
+			if (numa_local == false) {
+				chunk_event = parallel_max_miner::compute(cnds_buf, cnds_size, chunk_rules[ii], \
+					chunk_rules_size[ii], trans_ctx, chunk_min_supp, trans_range, chunk_event, backend);
+				return;
+			}
+
+			sycl_usm_arena partition_arena("mm_partition buffers");
+			MMN_TRANS_CONTEXT* partition_ctx = copy_partition(\
+				trans_ctx, trans_range, cnds_buf, cnds_size, partition_arena);
+
+			chunk_event = parallel_max_miner::compute(cnds_buf, cnds_size, chunk_rules[ii], \
+				chunk_rules_size[ii], partition_ctx, chunk_min_supp, std::make_pair(0, xe - xs), \
+					chunk_event, backend);
+
+			mm_bitmap::free_index(partition_ctx->m_tidsets);
+		};
+
+		std::vector<tbb::task_group> tgs(arenas.size());
+		for (std::size_t nn = 0; nn < arenas.size(); nn++)
+			arenas[nn]->execute([&, nn]() {
+				tgs[nn].run([&, nn]() {
+					tbb::parallel_for(tbb::blocked_range<std::size_t>(\
+						nn * chunks_n / arenas.size(), (nn + 1) * chunks_n / arenas.size()), \
+						[&](const tbb::blocked_range<std::size_t>& r) {
+							for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+								mine_partition(ii);
+						});
+				});
+			});
+
+		for (std::size_t nn = 0; nn < arenas.size(); nn++)
+			arenas[nn]->execute([&, nn]() { tgs[nn].wait(); });
+
+		// the partitions are merged in order, so the output does not depend on scheduling
+		merge_rules(rules_buf, rules_size, chunk_rules, chunk_rules_size);
+	}
+
+	template<class _Backend = mm_backend_default>
+	void compute(MMN_TRANS_CONTEXT* trans_ctx, \
+		MMN_RULE*& rules_buf, std::size_t& rules_size, bool tidset_index = true, \
+			bool trans_reduce = true)
+	{
+		MMN_RULE* cnds_buf = nullptr;
+		std::size_t cnds_size = \
+			trans_ctx->m_stats.m_items_cnt;
+
+		minmax_conf_type minmax_conf;
+		parallel_max_miner::init_model(cnds_buf, \
+			trans_ctx, cnds_size, minmax_conf);
+
+		// one threshold, taken from the spread of the item supports, holds for the whole run
+		const double min_supp = get_mean_conf(minmax_conf);
+		filter_cands(cnds_buf, cnds_size, [&](const MMN_RULE& rule) {
+			return (rule.m_supp_ab >= min_supp); });
+
+		if (tidset_index == true) {
+			mm_bitmap::build_index(trans_ctx->m_tidsets, \
+				trans_ctx, cnds_buf, cnds_size);
+		}
+
+		// the search starts from the items ranked by ascending support, as in Max-Miner,
+		// so the most frequent items end up in the tails that lookahead can prune
+		std::stable_sort(cnds_buf, cnds_buf + cnds_size, \
+			[&](const MMN_RULE& r1, const MMN_RULE& r2) {
+				return r1.m_supp_ab < r2.m_supp_ab;
+			});
+
+		const double trans_weight = get_weight(trans_ctx, \
+			std::make_pair(0, trans_ctx->m_stats.m_trans_cnt));
+
+		mine_partitions<_Backend>(cnds_buf, cnds_size, trans_ctx, \
+			min_supp, trans_weight, rules_buf, rules_size);
+
+		// phase two: the candidates are recounted over all transactions, reduced into
+		// a context of their own that goes with the arena
+		if (rules_size > 0L)
+		{
+			remove_duplicates(rules_buf, rules_size);
+
+			std::vector<double> items_supp(trans_ctx->m_stats.m_items_cnt, .0f);
+			std::vector<std::size_t> items_rank(trans_ctx->m_stats.m_items_cnt, 0L);
+			for (std::size_t ii = 0; ii < cnds_size; ii++) {
+				items_supp[cnds_buf[ii].m_v[0]] = cnds_buf[ii].m_supp_ab;
+				items_rank[cnds_buf[ii].m_v[0]] = ii;
+			}
+
+			sycl_usm_arena reduce_arena("mm_reduce buffers");
+			MMN_TRANS_CONTEXT* count_ctx = trans_ctx;
+			if (trans_reduce == true) {
+				MMN_TRANS_CONTEXT* reduced_ctx = nullptr;
+				mm_reduce::reduce_trans(trans_ctx, reduced_ctx, cnds_buf, cnds_size, reduce_arena);
+				if (reduced_ctx != nullptr) count_ctx = reduced_ctx;
+			}
+
+			if ((count_ctx != trans_ctx) && (tidset_index == true)) {
+				mm_bitmap::build_index(count_ctx->m_tidsets, \
+					count_ctx, cnds_buf, cnds_size);
+			}
+
+			auto count_sets = [&](MMN_RULE* sets_buf, const std::size_t sets_size) {
+				rank_parents(sets_buf, sets_size, items_rank);
+				count_rules(sets_buf, sets_size, count_ctx, items_supp); };
+
+			count_sets(rules_buf, rules_size);
+			shrink_rules(rules_buf, rules_size, min_supp, count_sets);
+
+			if (count_ctx != trans_ctx)
+				mm_bitmap::free_index(count_ctx->m_tidsets);
+
+			remove_subsets(rules_buf, rules_size);
+		}
+
+		// the index goes with the run, so the caller's context is left without one
+		mm_bitmap::free_index(trans_ctx->m_tidsets);
+	}
+
+	// adds the weighted support of every item over the transactions of the context
+	void count_items(const MMN_TRANS_CONTEXT* trans_ctx, std::vector<double>& items_supp)
+	{
+		tbb::enumerable_thread_specific<std::vector<double>> \
+			items_local(items_supp.size(), .0f);
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, trans_ctx->m_stats.m_trans_cnt), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				std::vector<double>& items_supp_local = items_local.local();
+				for (std::size_t tt = r.begin(); tt != r.end(); tt++)
+					for (std::size_t jj = 0; jj < trans_ctx->m_trans[tt].m_items; jj++)
+						items_supp_local[trans_ctx->m_trans[tt].m_v[jj]] += trans_ctx->m_trans[tt].m_weight;
+			});
+
+		for (auto& items_supp_local : items_local)
+			for (std::size_t ii = 0; ii < items_supp.size(); ii++)
+				items_supp[ii] += items_supp_local[ii];
+	}
+
+	// mines a file that does not fit in memory, one block at a time: the first sweep counts
+	// the items, the second mines every block as one more set of partitions, and the third
+	// recounts the merged candidates; stream_ctx receives the items and the file statistics
+	template<class _Backend = mm_backend_default>
+	void compute(mm_stream_reader& stream, MMN_TRANS_CONTEXT& stream_ctx, \
+		MMN_RULE*& rules_buf, std::size_t& rules_size, bool tidset_index = true, \
+			bool trans_reduce = true)
+	{
+		std::vector<double> items_supp;
+		MMN_TRANS_STATS& stats = stream_ctx.m_stats;
+
+		double trans_weight = .0f;
+
+		stream_ctx = MMN_TRANS_CONTEXT{};
+		for (std::size_t bb = 0; bb < stream.blocks(); bb++)
+		{
+			MMN_TRANS_CONTEXT* block_ctx = stream.load_block(bb);
+			if (block_ctx == nullptr) continue;
+
+			if ((stats.m_trans_min_len == 0L) || \
+				(block_ctx->m_stats.m_trans_min_len < stats.m_trans_min_len))
+				stats.m_trans_min_len = block_ctx->m_stats.m_trans_min_len;
+
+			stats.m_trans_max_len = std::max(stats.m_trans_max_len, \
+				block_ctx->m_stats.m_trans_max_len);
+
+			stats.m_trans_cnt += block_ctx->m_stats.m_trans_cnt;
+
+			// the item dictionary only grows, so the last block knows every item
+			stats.m_items_cnt = block_ctx->m_stats.m_items_cnt;
+			stats.m_item_max_len = block_ctx->m_stats.m_item_max_len;
+
+			items_supp.resize(stats.m_items_cnt, .0f);
+			count_items(block_ctx, items_supp);
+
+			trans_weight += get_weight(block_ctx, \
+				std::make_pair(0, block_ctx->m_stats.m_trans_cnt));
+		}
+
+		// a block's item table goes with the block, so the run's context keeps its own
+		stream_ctx.m_items = stream.model().items_snapshot();
+
+		MMN_RULE* cnds_buf = nullptr;
+		std::size_t cnds_size = 0L;
+
+		minmax_conf_type minmax_conf;
+		parallel_max_miner::init_model(cnds_buf, \
+			items_supp, stats.m_trans_cnt, cnds_size, minmax_conf);
+
+		// the threshold of the file holds for every block, scaled to the block's partitions
+		const double min_supp = get_mean_conf(minmax_conf);
+		filter_cands(cnds_buf, cnds_size, [&](const MMN_RULE& rule) {
+			return (rule.m_supp_ab >= min_supp); });
+
+		if (cnds_size == 0L) return;
+
+		std::stable_sort(cnds_buf, cnds_buf + cnds_size, \
+			[&](const MMN_RULE& r1, const MMN_RULE& r2) {
+				return r1.m_supp_ab < r2.m_supp_ab;
+			});
+
+		// the blocks are mined as they are and reduced only for the recount; the reduced
+		// transactions go with the block arena, and the index is released with the context
+		auto load_block = [&](const std::size_t bb, const bool reduce) {
+			MMN_TRANS_CONTEXT* block_ctx = stream.load_block(bb);
+			if (block_ctx == nullptr) return block_ctx;
+
+			if (reduce == true) {
+				MMN_TRANS_CONTEXT* reduced_ctx = nullptr;
+				mm_reduce::reduce_trans(block_ctx, reduced_ctx, \
+					cnds_buf, cnds_size, stream.block_arena());
+				if (reduced_ctx != nullptr) block_ctx = reduced_ctx;
+			}
+
+			if (tidset_index == true) {
+				mm_bitmap::build_index(block_ctx->m_tidsets, \
+					block_ctx, cnds_buf, cnds_size);
+			}
+
+			return block_ctx;
+		};
+
+		for (std::size_t bb = 0; bb < stream.blocks(); bb++)
+		{
+			MMN_TRANS_CONTEXT* block_ctx = load_block(bb, false);
+			if (block_ctx == nullptr) continue;
+
+			mine_partitions<_Backend>(cnds_buf, cnds_size, \
+				block_ctx, min_supp, trans_weight, rules_buf, rules_size);
+
+			// candidates found again by a later block are dropped as they arrive
+			if (rules_size > 0L)
+				remove_duplicates(rules_buf, rules_size);
+		}
+
+		if (rules_size == 0L) return;
+
+		std::vector<std::size_t> items_rank(stats.m_items_cnt, 0L);
+		for (std::size_t ii = 0; ii < cnds_size; ii++)
+			items_rank[cnds_buf[ii].m_v[0]] = ii;
+
+		// every recount is one more sweep over the blocks
+		auto count_sets = [&](MMN_RULE* sets_buf, const std::size_t sets_size) {
+			rank_parents(sets_buf, sets_size, items_rank);
+			clear_supports(sets_buf, sets_size);
+			for (std::size_t bb = 0; bb < stream.blocks(); bb++)
+			{
+				MMN_TRANS_CONTEXT* block_ctx = load_block(bb, trans_reduce);
+				if (block_ctx == nullptr) continue;
+
+				count_supports(sets_buf, sets_size, block_ctx);
+				mm_bitmap::free_index(block_ctx->m_tidsets);
+			}
+
+			update_conf(sets_buf, sets_size, items_supp);
+		};
+
+		count_sets(rules_buf, rules_size);
+		shrink_rules(rules_buf, rules_size, min_supp, count_sets);
+
+		remove_subsets(rules_buf, rules_size);
+	}
+
+	MMN_TRANS_CONTEXT* m_trans_ctx;
 };
\ No newline at end of file
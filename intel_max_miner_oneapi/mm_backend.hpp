@@ -0,0 +1,194 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#if defined(__has_include)
+#if __has_include(<execution>)
+#include <execution>
+#endif
+#endif
+
+#include "mm_types.hpp"
+#include "usm_alloc.hpp"
+#include "mm_topology.hpp"
+
+constexpr std::size_t g_work_group_max = 256;
+
+// the backends the mining kernels launch through, picked at compile time: a backend
+// launches a 1-D kernel over work-groups after an event and returns the event of the launch,
+// and reports the limits the launches are sized from; the host backends run the work-groups
+// as parallel tasks and the work-items of a group in order, so their launches complete
+// before they return and they offer no local memory or group barriers
+
+// the work-item of a host launch, with the part of nd_item the kernels use
+class mm_host_item
+{
+public:
+	mm_host_item(const std::size_t global_id, const std::size_t local_id) : \
+		m_global_id(global_id), m_local_id(local_id) {};
+
+	std::size_t get_global_id(const int) const { return m_global_id; }
+	std::size_t get_local_id(const int) const { return m_local_id; }
+
+private:
+	std::size_t m_global_id;
+	std::size_t m_local_id;
+};
+
+class mm_host_event
+{
+public:
+	void wait() {}
+	void wait_and_throw() {}
+};
+
+class mm_backend_tbb
+{
+public:
+	typedef mm_host_item item_type;
+	typedef mm_host_event event_type;
+
+	static constexpr const char* name = "tbb";
+	static constexpr USM_ALLOC_TYPE device_alloc = USM_ALLOC_TYPE::usm_alloc_crt;
+	static constexpr USM_ALLOC_TYPE shared_alloc = USM_ALLOC_TYPE::usm_alloc_crt;
+
+	std::size_t max_work_group_size() const { return g_work_group_max; }
+	std::size_t compute_units() const { return tbb::this_task_arena::max_concurrency(); }
+	std::size_t local_mem_size() const { return 0L; }
+
+	// the groups run in the caller's task arena, so a partition keeps its NUMA node
+	template<class _Kernel>
+	event_type parallel_for(const std::size_t items, const std::size_t wg, \
+		event_type event, const _Kernel& kernel)
+	{
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, items / wg), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t gg = r.begin(); gg != r.end(); gg++)
+					for (std::size_t ll = 0; ll < wg; ll++)
+						kernel(item_type(gg * wg + ll, ll));
+			});
+
+		return event;
+	}
+
+	template<class _Kernel>
+	event_type single_task(event_type event, const _Kernel& kernel) {
+		kernel(); return event;
+	}
+};
+
+#if defined(__cpp_lib_parallel_algorithm)
+class mm_backend_std
+{
+public:
+	typedef mm_host_item item_type;
+	typedef mm_host_event event_type;
+
+	static constexpr const char* name = "std";
+	static constexpr USM_ALLOC_TYPE device_alloc = USM_ALLOC_TYPE::usm_alloc_crt;
+	static constexpr USM_ALLOC_TYPE shared_alloc = USM_ALLOC_TYPE::usm_alloc_crt;
+
+	std::size_t max_work_group_size() const { return g_work_group_max; }
+	std::size_t compute_units() const { return mm_topology::threads(); }
+	std::size_t local_mem_size() const { return 0L; }
+
+	template<class _Kernel>
+	event_type parallel_for(const std::size_t items, const std::size_t wg, \
+		event_type event, const _Kernel& kernel)
+	{
+		std::vector<std::size_t> groups(items / wg);
+		std::iota(groups.begin(), groups.end(), 0L);
+
+		std::for_each(std::execution::par, groups.begin(), groups.end(), \
+			[&](const std::size_t gg) {
+				for (std::size_t ll = 0; ll < wg; ll++)
+					kernel(item_type(gg * wg + ll, ll));
+			});
+
+		return event;
+	}
+
+	template<class _Kernel>
+	event_type single_task(event_type event, const _Kernel& kernel) {
+		kernel(); return event;
+	}
+};
+#endif
+
+#if defined(MM_BACKEND_SYCL)
+// submits to the run's queue; the kernels see USM pointers and chain on the events
+class mm_backend_sycl
+{
+public:
+	typedef cl::sycl::nd_item<1> item_type;
+	typedef cl::sycl::event event_type;
+
+	static constexpr const char* name = "sycl";
+	static constexpr USM_ALLOC_TYPE device_alloc = USM_ALLOC_TYPE::usm_alloc_device;
+	static constexpr USM_ALLOC_TYPE shared_alloc = USM_ALLOC_TYPE::usm_alloc_shared;
+
+	mm_backend_sycl(cl::sycl::queue& device_queue = sycl_usm_queue::get()) : \
+		m_queue(device_queue) {};
+
+	std::size_t max_work_group_size() const {
+		return m_queue.get_device().get_info<cl::sycl::info::device::max_work_group_size>();
+	}
+
+	std::size_t compute_units() const {
+		return m_queue.get_device().get_info<cl::sycl::info::device::max_compute_units>();
+	}
+
+	std::size_t local_mem_size() const {
+		return m_queue.get_device().get_info<cl::sycl::info::device::local_mem_size>();
+	}
+
+	template<class _Kernel>
+	event_type parallel_for(const std::size_t items, const std::size_t wg, \
+		event_type event, const _Kernel& kernel)
+	{
+		return m_queue.submit([&](cl::sycl::handler& cgh) { \
+			cgh.depends_on(event);
+			cgh.parallel_for(cl::sycl::nd_range<1>{ items, wg }, kernel);
+		});
+	}
+
+	template<class _Kernel>
+	event_type single_task(event_type event, const _Kernel& kernel)
+	{
+		return m_queue.submit([&](cl::sycl::handler& cgh) { \
+			cgh.depends_on(event);
+			cgh.single_task(kernel);
+		});
+	}
+
+	cl::sycl::queue& queue() { return m_queue; }
+
+private:
+	cl::sycl::queue& m_queue;
+};
+#endif
+
+// -DMM_BACKEND_STD selects the C++17 parallel algorithms, otherwise
+// SYCL builds launch on the queue and plain C++ builds on TBB
+#if defined(MM_BACKEND_STD) && !defined(__cpp_lib_parallel_algorithm)
+#error "MM_BACKEND_STD requires a standard library with the C++17 parallel algorithms"
+#endif
+
+#if defined(MM_BACKEND_STD)
+typedef mm_backend_std mm_backend_default;
+#elif defined(MM_BACKEND_SYCL)
+typedef mm_backend_sycl mm_backend_default;
+#else
+typedef mm_backend_tbb mm_backend_default;
+#endif
@@ -0,0 +1,225 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+
+#include <limits>
+#include <algorithm>
+
+#if !defined(__SYCL_DEVICE_ONLY__) && (defined(__AVX2__) || defined(__AVX512F__))
+#include <immintrin.h>
+#endif
+
+#include "mm_types.hpp"
+#include "usm_alloc.hpp"
+#include "mm_profile.hpp"
+
+constexpr std::size_t g_tidset_max_items = 64;
+constexpr MMN_ITEM_ID g_tidset_no_row = \
+	std::numeric_limits<MMN_ITEM_ID>::max();
+
+class mm_bitmap
+{
+public:
+	static std::size_t popcount64(const std::uint64_t word) {
+#if defined(_MSC_VER) && !defined(__clang__)
+		return static_cast<std::size_t>(__popcnt64(word));
+#else
+		return static_cast<std::size_t>(__builtin_popcountll(word));
+#endif
+	}
+
+	static void build_index(MMN_TIDSET_INDEX*& index, \
+		const MMN_TRANS_CONTEXT* trans_ctx, const MMN_RULE* cnds_buf, const std::size_t cnds)
+	{
+		mm_profile::scope_timer timer("build_index");
+		sycl_usm_alloc_helper usm_alloc("mm_tidset buffers");
+
+		if ((index != nullptr) || (trans_ctx == nullptr) || (cnds == 0L))
+			return;
+
+		usm_alloc.alloc_buffer<MMN_TIDSET_INDEX>(index, 1);
+		usm_alloc.alloc_buffer<MMN_ITEM_ID>(index->m_rows, trans_ctx->m_stats.m_items_cnt);
+
+		std::fill(index->m_rows, index->m_rows + \
+			trans_ctx->m_stats.m_items_cnt, g_tidset_no_row);
+
+		for (std::size_t ii = 0; ii < cnds; ii++)
+			if (cnds_buf[ii].m_items == 1L)
+				index->m_rows[cnds_buf[ii].m_v[0]] = \
+					static_cast<MMN_ITEM_ID>(index->m_items++);
+
+		index->m_words = (trans_ctx->m_stats.m_trans_cnt + 63) / 64;
+		usm_alloc.alloc_buffer<std::uint64_t>(index->m_bits, \
+			index->m_items * index->m_words);
+
+		// each task owns whole 64-transaction words, so no two tasks touch the same word
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, index->m_words), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ww = r.begin(); ww != r.end(); ww++)
+				{
+					std::size_t tt_last = std::min<std::size_t>(\
+						(ww + 1) * 64, trans_ctx->m_stats.m_trans_cnt);
+					for (std::size_t tt = ww * 64; tt < tt_last; tt++)
+						for (std::size_t jj = 0; jj < trans_ctx->m_trans[tt].m_items; jj++)
+						{
+							MMN_ITEM_ID row = index->m_rows[trans_ctx->m_trans[tt].m_v[jj]];
+							if (row != g_tidset_no_row)
+								index->m_bits[row * index->m_words + ww] |= \
+									(std::uint64_t(1) << (tt % 64));
+						}
+				}
+			});
+
+		// weighted (merged) transactions get one bit plane per bit of their weight,
+		// so a weighted count is still a sum of shifted popcounts
+		std::size_t weight_max = 1L;
+		for (std::size_t tt = 0; tt < trans_ctx->m_stats.m_trans_cnt; tt++)
+			weight_max = std::max(weight_max, trans_ctx->m_trans[tt].m_weight);
+
+		for (index->m_planes = 0L; (weight_max > 1L) && \
+			((weight_max >> index->m_planes) != 0L); index->m_planes++);
+
+		usm_alloc.alloc_buffer<std::uint64_t>(index->m_weights, \
+			index->m_planes * index->m_words);
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, index->m_words), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ww = r.begin(); ww != r.end(); ww++)
+				{
+					std::size_t tt_last = std::min<std::size_t>(\
+						(ww + 1) * 64, trans_ctx->m_stats.m_trans_cnt);
+					for (std::size_t tt = ww * 64; tt < tt_last; tt++)
+						for (std::size_t pp = 0; pp < index->m_planes; pp++)
+							if (((trans_ctx->m_trans[tt].m_weight >> pp) & 1L) != 0L)
+								index->m_weights[pp * index->m_words + ww] |= \
+									(std::uint64_t(1) << (tt % 64));
+				}
+			});
+	}
+
+	static void free_index(MMN_TIDSET_INDEX*& index)
+	{
+		sycl_usm_alloc_helper usm_alloc("mm_tidset buffers");
+
+		if (index != nullptr) {
+			usm_alloc.free_buffer<std::uint64_t>(index->m_bits);
+			usm_alloc.free_buffer<std::uint64_t>(index->m_weights);
+			usm_alloc.free_buffer<MMN_ITEM_ID>(index->m_rows);
+			usm_alloc.free_buffer<MMN_TIDSET_INDEX>(index);
+		}
+	}
+
+	static std::size_t get_support(const MMN_TIDSET_INDEX* index, \
+		const MMN_ITEM_ID* items_buf, const std::size_t items_size, \
+		const std::size_t trans_first, const std::size_t trans_last)
+	{
+		const std::uint64_t* rows[g_tidset_max_items] = { nullptr };
+		if ((items_size == 0L) || (items_size > g_tidset_max_items) || \
+			(trans_first >= trans_last)) return 0L;
+
+		for (std::size_t ii = 0; ii < items_size; ii++) {
+			MMN_ITEM_ID row = index->m_rows[items_buf[ii]];
+			if (row == g_tidset_no_row) return 0L;
+			rows[ii] = index->m_bits + row * index->m_words;
+		}
+
+		std::size_t w_first = trans_first / 64;
+		std::size_t w_last = (trans_last - 1) / 64;
+
+		std::uint64_t mask_first = ~std::uint64_t(0) << (trans_first % 64);
+		std::uint64_t mask_last = ~std::uint64_t(0) >> (63 - ((trans_last - 1) % 64));
+
+		if (index->m_planes > 0L)
+		{
+			std::size_t count = 0L;
+			for (std::size_t ww = w_first; ww <= w_last; ww++)
+			{
+				std::uint64_t acc = and_word(rows, items_size, ww);
+				if (ww == w_first) acc &= mask_first;
+				if (ww == w_last) acc &= mask_last;
+
+				for (std::size_t pp = 0; pp < index->m_planes && acc != 0L; pp++)
+					count += popcount64(acc & index->m_weights[pp * index->m_words + ww]) << pp;
+			}
+
+			return count;
+		}
+
+		if (w_first == w_last)
+			return popcount64(and_word(rows, items_size, w_first) & mask_first & mask_last);
+
+		std::size_t count = \
+			popcount64(and_word(rows, items_size, w_first) & mask_first) + \
+			popcount64(and_word(rows, items_size, w_last) & mask_last);
+
+		return count + and_popcount(rows, items_size, w_first + 1, w_last);
+	}
+
+private:
+	static std::uint64_t and_word(const std::uint64_t* const* rows, \
+		const std::size_t rows_size, const std::size_t word)
+	{
+		std::uint64_t acc = rows[0][word];
+		for (std::size_t ii = 1; ii < rows_size && acc != 0L; ii++)
+			acc &= rows[ii][word];
+
+		return acc;
+	}
+
+	static std::size_t and_popcount(const std::uint64_t* const* rows, \
+		const std::size_t rows_size, std::size_t w_first, const std::size_t w_last)
+	{
+		std::size_t count = 0L;
+#if !defined(__SYCL_DEVICE_ONLY__) && defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+		__m512i count_v = _mm512_setzero_si512();
+		for (; w_first + 8 <= w_last; w_first += 8)
+		{
+			__m512i acc = _mm512_loadu_si512((const void*)(rows[0] + w_first));
+			for (std::size_t ii = 1; ii < rows_size; ii++)
+				acc = _mm512_and_si512(acc, \
+					_mm512_loadu_si512((const void*)(rows[ii] + w_first)));
+
+			count_v = _mm512_add_epi64(count_v, _mm512_popcnt_epi64(acc));
+		}
+
+		count += static_cast<std::size_t>(_mm512_reduce_add_epi64(count_v));
+#elif !defined(__SYCL_DEVICE_ONLY__) && defined(__AVX2__)
+		const __m256i lookup = _mm256_setr_epi8(\
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, \
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i low_mask = _mm256_set1_epi8(0x0f);
+
+		__m256i count_v = _mm256_setzero_si256();
+		for (; w_first + 4 <= w_last; w_first += 4)
+		{
+			__m256i acc = _mm256_loadu_si256((const __m256i*)(rows[0] + w_first));
+			for (std::size_t ii = 1; ii < rows_size; ii++)
+				acc = _mm256_and_si256(acc, \
+					_mm256_loadu_si256((const __m256i*)(rows[ii] + w_first)));
+
+			__m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(acc, low_mask));
+			__m256i hi = _mm256_shuffle_epi8(lookup, \
+				_mm256_and_si256(_mm256_srli_epi16(acc, 4), low_mask));
+
+			count_v = _mm256_add_epi64(count_v, _mm256_sad_epu8(\
+				_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+		}
+
+		count += static_cast<std::size_t>(_mm256_extract_epi64(count_v, 0)) + \
+			static_cast<std::size_t>(_mm256_extract_epi64(count_v, 1)) + \
+			static_cast<std::size_t>(_mm256_extract_epi64(count_v, 2)) + \
+			static_cast<std::size_t>(_mm256_extract_epi64(count_v, 3));
+#endif
+		for (; w_first < w_last; w_first++)
+			count += popcount64(and_word(rows, rows_size, w_first));
+
+		return count;
+	}
+};
@@ -0,0 +1,544 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/enumerable_thread_specific.h>
+
+#include <map>
+#include <set>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+#include "mm_types.hpp"
+#include "mm_trie.hpp"
+#include "usm_alloc.hpp"
+#include "mm_profile.hpp"
+
+typedef std::vector<MMN_ITEM_ID> mm_itemset;
+
+// an itemset of the border, its items in ascending order, with its weighted support
+typedef struct {
+	mm_itemset m_items;
+	double m_supp;
+} MMN_BORDER_SET;
+
+// maintains the maximal frequent itemsets of a growing transaction database together with its
+// negative border, the infrequent itemsets whose proper subsets are all frequent, at a minimum
+// support relative to the total weight (FUP with border maintenance); every item keeps its
+// support and the ascending list of transactions that hold it, so an itemset is counted over
+// any suffix of the history by intersecting its items' lists
+//
+// an appended batch is counted for the border itemsets alone. The border only moves when a
+// negative border itemset turns frequent or a maximal itemset falls below the raised minimum;
+// then the supersets of the former and the subsets of the latter are verified against the
+// whole history, and the negative border is redrawn around them alone
+class mm_incremental
+{
+public:
+	mm_incremental(const double min_supp) : m_min_supp(min_supp), m_weight(.0f)
+	{
+		if ((min_supp <= .0f) || (min_supp > 1.0f)) {
+			std::cerr << "Error: (mm_incremental) minimum support must be within (0, 1]\n";
+			exit(1);
+		}
+	}
+
+	virtual ~mm_incremental() {}
+
+public:
+	// appends the transactions of a batch that was loaded (unreduced) by the same model as
+	// every earlier batch, so the item IDs agree; returns whether the border has moved
+	bool append(const MMN_TRANS_CONTEXT* batch_ctx)
+	{
+		mm_profile::scope_timer timer("append_batch");
+
+		const std::size_t tid_first = m_trans_weight.size();
+		const std::size_t items_prev = m_items_supp.size();
+
+		append_trans(batch_ctx);
+
+		// the items first seen in this batch enter the border with no support so far
+		for (std::size_t ii = items_prev; ii < m_items_supp.size(); ii++)
+			m_border.push_back({ mm_itemset(1, static_cast<MMN_ITEM_ID>(ii)), .0f });
+
+		auto count_batch = [&](std::vector<MMN_BORDER_SET>& sets) {
+			tbb::parallel_for(tbb::blocked_range<std::size_t>(0, sets.size()), \
+				[&](const tbb::blocked_range<std::size_t>& r) {
+					for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+						sets[ii].m_supp += support(sets[ii].m_items, tid_first);
+				});
+		};
+
+		count_batch(m_maximal);
+		count_batch(m_border);
+
+		const double min_supp = min_support();
+		bool is_moved = \
+			std::any_of(m_maximal.begin(), m_maximal.end(), \
+				[&](const MMN_BORDER_SET& set) { return set.m_supp < min_supp; }) || \
+			std::any_of(m_border.begin(), m_border.end(), \
+				[&](const MMN_BORDER_SET& set) { return set.m_supp >= min_supp; });
+
+		if (is_moved == true)
+			update_border(min_supp);
+
+		return is_moved;
+	}
+
+	const std::vector<MMN_BORDER_SET>& maximal() const { return m_maximal; }
+	const std::vector<MMN_BORDER_SET>& border() const { return m_border; }
+
+	std::size_t trans() const { return m_trans_weight.size(); }
+	double weight() const { return m_weight; }
+	double min_support() const { return m_min_supp * m_weight; }
+
+	// the maximal itemsets as rules that print_rules takes, with the relative support as conf
+	void get_rules(MMN_RULE*& rules_buf, std::size_t& rules_size) const
+	{
+		sycl_usm_alloc_helper rules_alloc(\
+			"mm_rule buffers", USM_ALLOC_TYPE::usm_alloc_crt);
+
+		rules_size = m_maximal.size();
+		rules_alloc.alloc_buffer<MMN_RULE>(rules_buf, rules_size);
+
+		for (std::size_t ii = 0; ii < rules_size; ii++)
+		{
+			const MMN_BORDER_SET& set = m_maximal[ii];
+			rules_buf[ii].m_items = set.m_items.size();
+			rules_buf[ii].m_supp_a = rules_buf[ii].m_supp_b = m_weight;
+			rules_buf[ii].m_supp_ab = set.m_supp;
+			rules_buf[ii].m_conf = set.m_supp / m_weight;
+
+			rules_alloc.alloc_buffer<MMN_ITEM_ID>(rules_buf[ii].m_v, set.m_items.size());
+			std::memcpy(rules_buf[ii].m_v, set.m_items.data(), \
+				set.m_items.size() * sizeof(MMN_ITEM_ID));
+		}
+	}
+
+private:
+	void append_trans(const MMN_TRANS_CONTEXT* batch_ctx)
+	{
+		const std::size_t items = std::max(m_items_supp.size(), batch_ctx->m_stats.m_items_cnt);
+		m_items_supp.resize(items, .0f);
+		m_items_tids.resize(items);
+
+		for (std::size_t tt = 0; tt < batch_ctx->m_stats.m_trans_cnt; tt++)
+		{
+			const MMN_TRANS& trans = batch_ctx->m_trans[tt];
+			const std::size_t tid = m_trans_weight.size();
+			for (std::size_t jj = 0; jj < trans.m_items; jj++)
+			{
+				// a transaction lists each of its items once
+				std::vector<std::size_t>& tids = m_items_tids[trans.m_v[jj]];
+				if ((tids.empty() == false) && (tids.back() == tid))
+					continue;
+
+				tids.push_back(tid);
+				m_items_supp[trans.m_v[jj]] += trans.m_weight;
+			}
+
+			m_trans_weight.push_back(trans.m_weight);
+			m_weight += trans.m_weight;
+		}
+	}
+
+	// the weight of the transactions from tid_first on that hold the itemset: the shortest
+	// list is walked, and every other list is searched forward only
+	double support(const mm_itemset& items, const std::size_t tid_first = 0L) const
+	{
+		typedef std::pair<const std::size_t*, const std::size_t*> tids_range;
+
+		std::vector<tids_range> lists(items.size());
+		for (std::size_t kk = 0; kk < items.size(); kk++) {
+			const std::vector<std::size_t>& tids = m_items_tids[items[kk]];
+			const std::size_t* tids_last = tids.data() + tids.size();
+			lists[kk] = std::make_pair(std::lower_bound(tids.data(), tids_last, tid_first), tids_last);
+		}
+
+		std::sort(lists.begin(), lists.end(), [](const tids_range& l1, const tids_range& l2) {
+			return (l1.second - l1.first) < (l2.second - l2.first); });
+
+		double supp = .0f;
+		for (const std::size_t* tid = lists[0].first; tid != lists[0].second; tid++)
+		{
+			bool is_found = true;
+			for (std::size_t kk = 1; (is_found == true) && (kk < lists.size()); kk++) {
+				lists[kk].first = std::lower_bound(lists[kk].first, lists[kk].second, *tid);
+				is_found = (lists[kk].first != lists[kk].second) && (*lists[kk].first == *tid);
+			}
+
+			if (is_found == true)
+				supp += m_trans_weight[*tid];
+		}
+
+		return supp;
+	}
+
+	void intersect(const std::vector<std::size_t>& tids, const MMN_ITEM_ID item, \
+		std::vector<std::size_t>& tids_new) const
+	{
+		const std::vector<std::size_t>& item_tids = m_items_tids[item];
+		tids_new.clear();
+		std::set_intersection(tids.begin(), tids.end(), \
+			item_tids.begin(), item_tids.end(), std::back_inserter(tids_new));
+	}
+
+	double weight(const std::vector<std::size_t>& tids) const
+	{
+		double supp = .0f;
+		for (std::size_t tid : tids)
+			supp += m_trans_weight[tid];
+		return supp;
+	}
+
+	// Max-Miner's search below a head that turned frequent: the tail holds the frequent items
+	// that may still extend it, ranked by ascending support, and a head that is frequent
+	// together with its whole frequent tail reports that set instead of being expanded
+	void grow_head(mm_itemset& head, const std::vector<std::size_t>& head_tids, \
+		const mm_itemset& tail, const double min_supp, std::vector<mm_itemset>& found) const
+	{
+		std::vector<std::pair<double, MMN_ITEM_ID>> tail_freq;
+		std::vector<std::vector<std::size_t>> tail_tids;
+		std::vector<std::size_t> tids_new;
+		for (MMN_ITEM_ID item : tail)
+		{
+			intersect(head_tids, item, tids_new);
+			double supp = weight(tids_new);
+			if (supp >= min_supp) {
+				tail_freq.push_back(std::make_pair(supp, item));
+				tail_tids.push_back(tids_new);
+			}
+		}
+
+		auto report = [&](const mm_itemset& items) {
+			found.push_back(items);
+			std::sort(found.back().begin(), found.back().end());
+		};
+
+		if (tail_freq.empty() == true) {
+			report(head); return;
+		}
+
+		// lookahead: the head with its whole frequent tail
+		std::vector<std::size_t> tids_all = tail_tids[0];
+		for (std::size_t kk = 1; (kk < tail_freq.size()) && (tids_all.empty() == false); kk++) {
+			intersect(tids_all, tail_freq[kk].second, tids_new);
+			tids_all.swap(tids_new);
+		}
+
+		if ((tail_freq.size() > 1L) && (weight(tids_all) >= min_supp))
+		{
+			mm_itemset items(head);
+			for (auto& item : tail_freq)
+				items.push_back(item.second);
+
+			report(items); return;
+		}
+
+		std::vector<std::size_t> tail_order(tail_freq.size());
+		for (std::size_t kk = 0; kk < tail_order.size(); kk++)
+			tail_order[kk] = kk;
+
+		std::stable_sort(tail_order.begin(), tail_order.end(), \
+			[&](const std::size_t k1, const std::size_t k2) {
+				return tail_freq[k1].first < tail_freq[k2].first; });
+
+		for (std::size_t kk = 0; kk < tail_order.size(); kk++)
+		{
+			mm_itemset tail_next;
+			for (std::size_t jj = kk + 1; jj < tail_order.size(); jj++)
+				tail_next.push_back(tail_freq[tail_order[jj]].second);
+
+			head.push_back(tail_freq[tail_order[kk]].second);
+			grow_head(head, tail_tids[tail_order[kk]], tail_next, min_supp, found);
+			head.pop_back();
+		}
+	}
+
+	// the largest frequent subsets of a maximal itemset that fell below the minimum and that no
+	// other maximal itemset contains: the subsets are visited level by level, each one once,
+	// and only the infrequent ones are split further; the infrequent subsets whose own subsets
+	// are all frequent join the negative border
+	void shrink_set(const MMN_BORDER_SET& demoted, const mm_itemset_trie& maximal_trie, \
+		const double min_supp, std::vector<mm_itemset>& found, std::vector<MMN_BORDER_SET>& border) const
+	{
+		std::set<mm_itemset> visited;
+		std::map<mm_itemset, double> infrequent;
+		infrequent[demoted.m_items] = demoted.m_supp;
+
+		std::vector<mm_itemset> level(1, demoted.m_items);
+		while ((level.empty() == false) && (level[0].size() > 1L))
+		{
+			std::vector<mm_itemset> level_next;
+			for (const mm_itemset& set : level)
+				for (std::size_t kk = 0; kk < set.size(); kk++)
+				{
+					mm_itemset subset(set);
+					subset.erase(subset.begin() + kk);
+
+					if ((visited.insert(subset).second == false) || \
+						(maximal_trie.has_superset(subset.data(), subset.size()) == true))
+						continue;
+
+					double supp = support(subset);
+					if (supp >= min_supp)
+						found.push_back(subset);
+					else {
+						infrequent[subset] = supp;
+						level_next.push_back(subset);
+					}
+				}
+
+			level.swap(level_next);
+		}
+
+		for (auto& set : infrequent)
+		{
+			bool is_minimal = true;
+			for (std::size_t kk = 0; (is_minimal == true) && (kk < set.first.size()) && \
+				(set.first.size() > 1L); kk++)
+			{
+				mm_itemset subset(set.first);
+				subset.erase(subset.begin() + kk);
+				is_minimal = (infrequent.find(subset) == infrequent.end());
+			}
+
+			if (is_minimal == true)
+				border.push_back({ set.first, set.second });
+		}
+	}
+
+	// the negative border itemsets above an itemset that turned frequent: such an itemset is
+	// the frequent one joined with a minimal transversal of the complements of the maximal
+	// itemsets that contain it (Berge's algorithm), so only those maximal itemsets are dualized
+	void border_above(const mm_itemset& items, const mm_itemset& items_freq, \
+		const mm_itemset_trie& maximal_trie, std::vector<MMN_BORDER_SET>& border) const
+	{
+		std::vector<mm_itemset> complements;
+		for (const MMN_BORDER_SET& set : m_maximal)
+			if (std::includes(set.m_items.begin(), set.m_items.end(), items.begin(), items.end()))
+			{
+				complements.push_back(mm_itemset());
+				std::set_difference(items_freq.begin(), items_freq.end(), \
+					set.m_items.begin(), set.m_items.end(), std::back_inserter(complements.back()));
+			}
+
+		// the shortest complements first keep the transversals few
+		std::stable_sort(complements.begin(), complements.end(), \
+			[](const mm_itemset& c1, const mm_itemset& c2) { return c1.size() < c2.size(); });
+
+		std::vector<mm_itemset> transversals(1, mm_itemset());
+		for (const mm_itemset& complement : complements)
+		{
+			std::vector<mm_itemset> transversals_new;
+			for (const mm_itemset& transversal : transversals)
+			{
+				bool is_hit = std::any_of(transversal.begin(), transversal.end(), \
+					[&](const MMN_ITEM_ID item) {
+						return std::binary_search(complement.begin(), complement.end(), item); });
+
+				if (is_hit == true) {
+					transversals_new.push_back(transversal); continue;
+				}
+
+				for (MMN_ITEM_ID item : complement) {
+					mm_itemset extended(transversal);
+					extended.insert(std::upper_bound(extended.begin(), extended.end(), item), item);
+					transversals_new.push_back(extended);
+				}
+			}
+
+			// only the minimal transversals are carried on, the shortest ones first
+			std::stable_sort(transversals_new.begin(), transversals_new.end(), \
+				[](const mm_itemset& t1, const mm_itemset& t2) { return t1.size() < t2.size(); });
+
+			mm_itemset_trie minimal_trie;
+			transversals.clear();
+			for (const mm_itemset& transversal : transversals_new)
+				if (minimal_trie.has_subset(transversal.data(), transversal.size()) == false) {
+					minimal_trie.insert(transversal.data(), transversal.size());
+					transversals.push_back(transversal);
+				}
+		}
+
+		// the joined itemset is on the border unless an item of the frequent one is redundant
+		for (const mm_itemset& transversal : transversals)
+		{
+			mm_itemset set;
+			std::merge(items.begin(), items.end(), \
+				transversal.begin(), transversal.end(), std::back_inserter(set));
+
+			if (is_border(set, maximal_trie) == true)
+				border.push_back({ set, -1.0f });
+		}
+	}
+
+	static bool is_border(const mm_itemset& items, const mm_itemset_trie& maximal_trie)
+	{
+		if (maximal_trie.has_superset(items.data(), items.size()) == true)
+			return false;
+
+		for (std::size_t kk = 0; kk < items.size(); kk++) {
+			mm_itemset subset(items);
+			subset.erase(subset.begin() + kk);
+			if (maximal_trie.has_superset(subset.data(), subset.size()) == false)
+				return false;
+		}
+
+		return true;
+	}
+
+	void update_border(const double min_supp)
+	{
+		mm_profile::scope_timer timer("update_border");
+
+		std::vector<MMN_BORDER_SET> kept, demoted, promoted, border_kept;
+		for (const MMN_BORDER_SET& set : m_maximal)
+			((set.m_supp >= min_supp) ? kept : demoted).push_back(set);
+
+		for (const MMN_BORDER_SET& set : m_border)
+			((set.m_supp >= min_supp) ? promoted : border_kept).push_back(set);
+
+		mm_itemset items_freq;
+		for (std::size_t ii = 0; ii < m_items_supp.size(); ii++)
+			if (m_items_supp[ii] >= min_supp)
+				items_freq.push_back(static_cast<MMN_ITEM_ID>(ii));
+
+		// an itemset holding several items that turned frequent is searched below the least of them
+		mm_itemset items_promoted;
+		for (const MMN_BORDER_SET& set : promoted)
+			if (set.m_items.size() == 1L)
+				items_promoted.push_back(set.m_items[0]);
+
+		std::sort(items_promoted.begin(), items_promoted.end());
+
+		tbb::enumerable_thread_specific<std::vector<mm_itemset>> found_local;
+		tbb::enumerable_thread_specific<std::vector<MMN_BORDER_SET>> border_local;
+
+		// every new frequent itemset contains an itemset that left the negative border
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, promoted.size()), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+				{
+					mm_itemset head = promoted[ii].m_items, tail;
+					std::set_difference(items_freq.begin(), items_freq.end(), \
+						head.begin(), head.end(), std::back_inserter(tail));
+
+					if (head.size() == 1L)
+						tail.erase(std::remove_if(tail.begin(), tail.end(), \
+							[&](const MMN_ITEM_ID item) { return (item < head[0]) && \
+								std::binary_search(items_promoted.begin(), items_promoted.end(), item); }), \
+							tail.end());
+
+					std::stable_sort(tail.begin(), tail.end(), \
+						[&](const MMN_ITEM_ID i1, const MMN_ITEM_ID i2) {
+							return m_items_supp[i1] < m_items_supp[i2]; });
+
+					std::vector<std::size_t> head_tids = m_items_tids[head[0]], tids_new;
+					for (std::size_t kk = 1; kk < head.size(); kk++) {
+						intersect(head_tids, head[kk], tids_new);
+						head_tids.swap(tids_new);
+					}
+
+					grow_head(head, head_tids, tail, min_supp, found_local.local());
+				}
+			});
+
+		mm_itemset_trie maximal_trie;
+		for (const MMN_BORDER_SET& set : kept)
+			maximal_trie.insert(set.m_items.data(), set.m_items.size());
+		for (auto& found : found_local)
+			for (const mm_itemset& items : found)
+				maximal_trie.insert(items.data(), items.size());
+
+		// an itemset that was frequent before stays so unless all the maximal itemsets
+		// that contained it were demoted
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, demoted.size()), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+					shrink_set(demoted[ii], maximal_trie, min_supp, \
+						found_local.local(), border_local.local());
+			});
+
+		std::vector<mm_itemset> candidates;
+		for (const MMN_BORDER_SET& set : kept)
+			candidates.push_back(set.m_items);
+		for (auto& found : found_local)
+			candidates.insert(candidates.end(), found.begin(), found.end());
+
+		// the maximal candidates, the largest first; only the new ones are counted
+		std::stable_sort(candidates.begin(), candidates.end(), \
+			[](const mm_itemset& s1, const mm_itemset& s2) {
+				return (s1.size() > s2.size()) || ((s1.size() == s2.size()) && (s1 < s2)); });
+
+		std::map<mm_itemset, double> kept_supp;
+		for (const MMN_BORDER_SET& set : kept)
+			kept_supp[set.m_items] = set.m_supp;
+
+		maximal_trie.clear();
+		m_maximal.clear();
+		for (const mm_itemset& items : candidates)
+			if (maximal_trie.has_superset(items.data(), items.size()) == false) {
+				maximal_trie.insert(items.data(), items.size());
+				auto supp_it = kept_supp.find(items);
+				m_maximal.push_back({ items, (supp_it != kept_supp.end()) ? supp_it->second : -1.0f });
+			}
+
+		// the new negative border: the former one less the itemsets a demoted one now lies below,
+		// the minimal infrequent subsets of the demoted itemsets and the border above the promoted ones
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, promoted.size()), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+					border_above(promoted[ii].m_items, items_freq, maximal_trie, border_local.local());
+			});
+
+		m_border.clear();
+		for (const MMN_BORDER_SET& set : border_kept)
+			if (is_border(set.m_items, maximal_trie) == true)
+				m_border.push_back(set);
+		for (auto& border : border_local)
+			m_border.insert(m_border.end(), border.begin(), border.end());
+
+		std::stable_sort(m_border.begin(), m_border.end(), \
+			[](const MMN_BORDER_SET& s1, const MMN_BORDER_SET& s2) {
+				return (s1.m_items.size() < s2.m_items.size()) || \
+					((s1.m_items.size() == s2.m_items.size()) && (s1.m_items < s2.m_items)); });
+
+		m_border.erase(std::unique(m_border.begin(), m_border.end(), \
+			[](const MMN_BORDER_SET& s1, const MMN_BORDER_SET& s2) { return s1.m_items == s2.m_items; }), \
+			m_border.end());
+
+		// the itemsets that are new to the border are counted over the whole history
+		auto count_new = [&](std::vector<MMN_BORDER_SET>& sets) {
+			tbb::parallel_for(tbb::blocked_range<std::size_t>(0, sets.size()), \
+				[&](const tbb::blocked_range<std::size_t>& r) {
+					for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+						if (sets[ii].m_supp < .0f)
+							sets[ii].m_supp = support(sets[ii].m_items);
+				});
+		};
+
+		count_new(m_maximal);
+		count_new(m_border);
+	}
+
+private:
+	const double m_min_supp;
+	double m_weight;
+
+	std::vector<double> m_items_supp;
+	std::vector<std::vector<std::size_t>> m_items_tids;
+	std::vector<std::size_t> m_trans_weight;
+
+	std::vector<MMN_BORDER_SET> m_maximal;
+	std::vector<MMN_BORDER_SET> m_border;
+};
@@ -0,0 +1,100 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+class mm_mapped_file
+{
+public:
+	mm_mapped_file(const char* filename) : m_data(nullptr), m_size(0L) {
+#if defined(_WIN32)
+		m_file = ::CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, \
+			nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE) return;
+
+		LARGE_INTEGER file_size;
+		if ((::GetFileSizeEx(m_file, &file_size) == FALSE) || \
+			(file_size.QuadPart == 0)) return;
+
+		m_mapping = ::CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping == nullptr) return;
+
+		m_data = static_cast<const char*>(\
+			::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		m_size = (m_data != nullptr) ? static_cast<std::size_t>(file_size.QuadPart) : 0L;
+#else
+		m_fd = ::open(filename, O_RDONLY);
+		if (m_fd < 0) return;
+
+		struct stat st;
+		if ((::fstat(m_fd, &st) != 0) || (st.st_size == 0)) return;
+
+		void* data = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), \
+			PROT_READ, MAP_PRIVATE, m_fd, 0);
+		if (data == MAP_FAILED) return;
+
+		::madvise(data, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+
+		m_data = static_cast<const char*>(data);
+		m_size = static_cast<std::size_t>(st.st_size);
+#endif
+	}
+
+	mm_mapped_file(const mm_mapped_file&) = delete;
+	mm_mapped_file& operator=(const mm_mapped_file&) = delete;
+
+	virtual ~mm_mapped_file() {
+#if defined(_WIN32)
+		if (m_data != nullptr) ::UnmapViewOfFile(m_data);
+		if (m_mapping != nullptr) ::CloseHandle(m_mapping);
+		if (m_file != INVALID_HANDLE_VALUE) ::CloseHandle(m_file);
+#else
+		if (m_data != nullptr) ::munmap(const_cast<char*>(m_data), m_size);
+		if (m_fd >= 0) ::close(m_fd);
+#endif
+	}
+
+public:
+	bool is_open() const { return m_data != nullptr; }
+	const char* data() const { return m_data; }
+	std::size_t size() const { return m_size; }
+
+	// hands the pages of a range that has been consumed back to the system
+	void discard(const std::size_t offset, const std::size_t size) {
+#if !defined(_WIN32)
+		const std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+		std::size_t first = (offset + page_size - 1) & ~(page_size - 1);
+		std::size_t last = std::min(offset + size, m_size) & ~(page_size - 1);
+		if ((m_data != nullptr) && (first < last))
+			::madvise(const_cast<char*>(m_data) + first, last - first, MADV_DONTNEED);
+#endif
+	}
+
+private:
+	const char*  m_data;
+	std::size_t  m_size;
+#if defined(_WIN32)
+	HANDLE       m_file = INVALID_HANDLE_VALUE;
+	HANDLE       m_mapping = nullptr;
+#else
+	int          m_fd = -1;
+#endif
+};
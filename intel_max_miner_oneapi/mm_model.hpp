@@ -1,169 +1,466 @@
-//==============================================================
-// Copyright  2020 Intel Corporation
-//
-// SPDX-License-Identifier: MIT
-// =============================================================
-
-#pragma once
-
-#include <string.h>
-
-#include <tbb/tbb.h>
-#include <tbb/parallel_pipeline.h>
-
-#include <string>
-#include <fstream>
-#include <iostream>
-#include <algorithm>
-
-#include "mm_types.hpp"
-#include "usm_string.hpp"
-#include "mm_vector.hpp"
-
-using namespace std;
-
-class mm_model
-{
-public:
-    mm_model(USM_ALLOC_TYPE alloc_type = USM_ALLOC_TYPE::usm_alloc_crt) : \
-            m_alloc_type(alloc_type) {};
-    virtual ~mm_model() {}
-
-public:
-    void load_trans_from_file(const char* filename, \
-        MMN_TRANS_CONTEXT*& mmn_trans_ctx)
-    {
-        std::ifstream ifs;
-        std::size_t items = 0L;
-        std::size_t trans = 0L;
-        std::size_t item_max_len = 0L;
-        std::size_t trans_min_len = 0L;
-        std::size_t trans_max_len = 0L;
-
-        MMN_ITEM* uitems_buf = nullptr;
-        MMN_TRANS* trans_buf = nullptr;
-        sycl_usm_alloc_helper usm_alloc( \
-            "mm_model buffers", m_alloc_type);
-
-        ifs.exceptions(std::ifstream::badbit);
-
-        try
-        {
-            ifs.open(filename, std::ios::in);
-            auto mp = tbb::global_control::max_allowed_parallelism;
-            tbb::global_control gc(mp, g_threads);
-
-            tbb::task_group task_group;
-            task_group.run_and_wait([&] {
-                tbb::parallel_pipeline(ULLONG_MAX,
-                    tbb::make_filter<void, char*>(
-                        tbb::filter_mode::serial_in_order,
-                        [&](tbb::flow_control& fc)-> char* {
-                            char* lbuf = nullptr;
-                            string line_buf = "\0";
-                            if (ifs.eof()) { fc.stop(); return lbuf; }
-                            else if (getline(ifs, line_buf)) {
-                                usm_alloc.alloc_buffer<char>(lbuf, strlen(line_buf.c_str()) + 1);
-                                usm_string_helper::strcpy(lbuf, strlen(line_buf.c_str()) + 1, \
-                                    const_cast<char*>(line_buf.c_str()), strlen(line_buf.c_str()));
-                            }
-
-                            return lbuf;
-                        }) &
-                    tbb::make_filter<char*, MMN_TRANS*>(
-                        tbb::filter_mode::serial_in_order,
-                        [&](char* lbuf)-> MMN_TRANS* {
-                            std::size_t tti = 0L;
-                            static char delim[] = ",";
-                            MMN_TRANS* tt_buf = nullptr;
-                            char* token = nullptr, *next_token = token;
-                            usm_alloc.alloc_buffer<MMN_TRANS>(tt_buf, 1);
-
-                            MMN_ITEM* items_buf = nullptr;
-                            for (token = strtok_s(lbuf, delim, &next_token); \
-                                token != nullptr; token = strtok_s(nullptr, delim, &next_token))
-                            {
-                                usm_alloc.realloc_buf_async<MMN_ITEM>(items_buf, (tti + 1));
-
-                                items_buf[tti].m_buf  = nullptr;
-                                items_buf[tti].m_size = strlen(token);
-
-                                usm_alloc.alloc_buffer<char>(\
-                                    items_buf[tti].m_buf, items_buf[tti].m_size + 1);
-                                usm_string_helper::strcpy(items_buf[tti].m_buf, \
-                                    items_buf[tti].m_size + 1, token, items_buf[tti].m_size);
-
-                                if (!mm_vector::exists(uitems_buf, items, token))
-                                {
-                                    usm_alloc.realloc_buf_async<MMN_ITEM>(uitems_buf, (items + 1));
-
-                                    uitems_buf[items].m_buf = nullptr;
-                                    uitems_buf[items].m_size = strlen(token);
-
-                                    usm_alloc.alloc_buffer<char>(\
-                                        uitems_buf[items].m_buf, uitems_buf[items].m_size + 1);
-                                    usm_string_helper::strcpy(uitems_buf[items].m_buf, \
-                                        uitems_buf[items].m_size + 1, token, strlen(token));
-
-                                    items++;
-                                }
-
-                                if ((strlen(token) > item_max_len) || (item_max_len == 0))
-                                    item_max_len = strlen(token);
-
-                                tti++;
-                            }
-
-                            if ((tti > 0L) && (items_buf != nullptr)) {
-                                tt_buf->m_items = tti;
-                                tt_buf->m_v = items_buf;
-                            }
-
-                            return tt_buf;
-                        }) &
-                    tbb::make_filter<MMN_TRANS*, void>(
-                        tbb::filter_mode::serial_in_order,
-                        [&](MMN_TRANS* tt_buf)-> void {
-
-                            usm_alloc.realloc_buf_async<MMN_TRANS>(trans_buf, (trans + 1));
-
-                            if (tt_buf != nullptr) {
-                                trans_buf[trans++] = *tt_buf;
-
-                                if ((tt_buf->m_items < trans_min_len) ||
-                                    (trans_min_len == 0L)) {
-                                    trans_min_len = tt_buf->m_items;
-                                }
-
-                                if ((tt_buf->m_items > trans_max_len) ||
-                                    (trans_max_len == 0L)) {
-                                    trans_max_len = tt_buf->m_items;
-                                }
-                            }
-                        }));
-            });
-        }
-
-        catch (std::ifstream::failure e) {
-            std::cerr << "Unable to read file: " << filename << "\n";
-            exit(1);
-        }
-
-        if (mmn_trans_ctx == nullptr)
-        {
-            MMN_TRANS_STATS stats;
-            stats.m_trans_cnt = trans;
-            stats.m_items_cnt = items;
-            stats.m_item_max_len  = item_max_len;
-            stats.m_trans_min_len = trans_min_len;
-            stats.m_trans_max_len = trans_max_len;
-
-            if ((uitems_buf != nullptr) && (trans_buf != nullptr)) {
-               usm_alloc.alloc_trans_ctx(mmn_trans_ctx, uitems_buf, trans_buf, stats);
-            }
-        }
-    }
-
-private:
-    USM_ALLOC_TYPE	m_alloc_type;
-};
\ No newline at end of file
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <string.h>
+
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+#include <iostream>
+#include <algorithm>
+
+#include "mm_types.hpp"
+#include "mm_mmap.hpp"
+#include "usm_alloc.hpp"
+#include "usm_string.hpp"
+#include "mm_vector.hpp"
+#include "mm_topology.hpp"
+#include "mm_profile.hpp"
+
+using namespace std;
+
+constexpr std::size_t g_load_chunk_min_size = 1L << 20;
+
+constexpr char g_cache_magic[] = "MMNCACHE";
+constexpr std::uint32_t g_cache_version = 1;
+constexpr std::uint32_t g_cache_byte_order = 0x01020304;
+constexpr std::size_t g_cache_align = 64L;
+
+class mm_model
+{
+public:
+    mm_model(USM_ALLOC_TYPE alloc_type = USM_ALLOC_TYPE::usm_alloc_crt) : \
+            m_alloc_type(alloc_type), m_arena("mm_model buffers", g_arena_slab_size, alloc_type) {};
+    virtual ~mm_model() {}
+
+public:
+    void load_trans_from_file(const char* filename, \
+        MMN_TRANS_CONTEXT*& mmn_trans_ctx)
+    {
+        mm_profile::scope_timer timer("load_trans_from_file");
+
+        // the context and its item strings live in the model's arena until the model is destroyed
+        sycl_usm_alloc_helper usm_alloc( \
+            "mm_model buffers", m_alloc_type, &m_arena);
+
+        std::unique_ptr<mm_mapped_file> file(new mm_mapped_file(filename));
+        if (file->is_open() == false) {
+            std::cerr << "Unable to read file: " << filename << "\n";
+            exit(1);
+        }
+
+        // a binary cache is mapped instead of parsed: item strings and transactions point
+        // straight into the mapping, which stays open with the model
+        if (is_trans_cache(*file) == true)
+        {
+            const MMN_CACHE_HEADER* header = open_trans_cache(*file);
+            if (header == nullptr) {
+                std::cerr << "Error: (mm_model) unsupported cache file: " << filename << "\n";
+                exit(1);
+            }
+
+            load_trans_cache(*file, 0L, header->m_trans_cnt, mmn_trans_ctx, usm_alloc);
+            m_caches.push_back(std::move(file));
+            return;
+        }
+
+        load_trans(file->data(), file->size(), mmn_trans_ctx, usm_alloc);
+    }
+
+    // parses one block of whole lines into a context held by block_arena; the item
+    // dictionary stays with the model, so every block numbers its items the same way
+    void load_trans_block(const char* data, const std::size_t size, \
+        MMN_TRANS_CONTEXT*& mmn_trans_ctx, sycl_usm_arena& block_arena)
+    {
+        sycl_usm_alloc_helper usm_alloc( \
+            "mm_model block buffers", m_alloc_type, &block_arena);
+
+        load_trans(data, size, mmn_trans_ctx, usm_alloc);
+    }
+
+    // the item table grows with every load (and is replaced by an opened cache), so a context
+    // gets a copy of it as of its load, allocated along with the context
+    MMN_ITEM* items_snapshot(sycl_usm_alloc_helper& usm_alloc) const
+    {
+        MMN_ITEM* items_buf = nullptr;
+        usm_alloc.alloc_buffer<MMN_ITEM>(items_buf, m_items.size());
+        std::copy(m_items.begin(), m_items.end(), items_buf);
+        return items_buf;
+    }
+
+    // a copy that lives as long as the model
+    MMN_ITEM* items_snapshot()
+    {
+        sycl_usm_alloc_helper usm_alloc( \
+            "mm_model buffers", m_alloc_type, &m_arena);
+        return items_snapshot(usm_alloc);
+    }
+
+    // writes the context as a binary cache, which load_trans_from_file maps back
+    static bool save_trans_to_cache(const char* filename, \
+        const MMN_TRANS_CONTEXT* mmn_trans_ctx)
+    {
+        const std::size_t items = mmn_trans_ctx->m_stats.m_items_cnt;
+        const std::size_t trans = mmn_trans_ctx->m_stats.m_trans_cnt;
+
+        std::vector<std::uint64_t> items_offs(items + 1, 0L);
+        for (std::size_t ii = 0; ii < items; ii++)
+            items_offs[ii + 1] = items_offs[ii] + mmn_trans_ctx->m_items[ii].m_size + 1;
+
+        std::vector<std::uint64_t> trans_offs(trans + 1, 0L);
+        std::vector<std::uint64_t> trans_weights(trans, 0L);
+        for (std::size_t tt = 0; tt < trans; tt++) {
+            trans_offs[tt + 1] = trans_offs[tt] + mmn_trans_ctx->m_trans[tt].m_items;
+            trans_weights[tt] = mmn_trans_ctx->m_trans[tt].m_weight;
+        }
+
+        MMN_CACHE_HEADER header = {};
+        std::memcpy(header.m_magic, g_cache_magic, sizeof(header.m_magic));
+        header.m_version = g_cache_version;
+        header.m_byte_order = g_cache_byte_order;
+        header.m_trans_cnt = trans;
+        header.m_items_cnt = items;
+        header.m_item_max_len = mmn_trans_ctx->m_stats.m_item_max_len;
+        header.m_trans_min_len = mmn_trans_ctx->m_stats.m_trans_min_len;
+        header.m_trans_max_len = mmn_trans_ctx->m_stats.m_trans_max_len;
+        header.m_pool_size = trans_offs[trans];
+
+        header.m_items_offs = cache_align(sizeof(MMN_CACHE_HEADER));
+        header.m_chars_offs = cache_align(header.m_items_offs + (items + 1) * sizeof(std::uint64_t));
+        header.m_trans_offs = cache_align(header.m_chars_offs + items_offs[items]);
+        header.m_weights_offs = cache_align(header.m_trans_offs + (trans + 1) * sizeof(std::uint64_t));
+        header.m_pool_offs = cache_align(header.m_weights_offs + trans * sizeof(std::uint64_t));
+
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (file.is_open() == false) {
+            std::cerr << "Unable to write file: " << filename << "\n";
+            return false;
+        }
+
+        // the sections are written in file order, padded up to their aligned offsets
+        auto pad_to = [&](const std::uint64_t offs) {
+            static const char padding[g_cache_align] = { 0 };
+            file.write(padding, offs - static_cast<std::uint64_t>(file.tellp()));
+        };
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(MMN_CACHE_HEADER));
+
+        pad_to(header.m_items_offs);
+        file.write(reinterpret_cast<const char*>(items_offs.data()), \
+            items_offs.size() * sizeof(std::uint64_t));
+
+        pad_to(header.m_chars_offs);
+        for (std::size_t ii = 0; ii < items; ii++)
+            file.write(mmn_trans_ctx->m_items[ii].m_buf, mmn_trans_ctx->m_items[ii].m_size + 1);
+
+        pad_to(header.m_trans_offs);
+        file.write(reinterpret_cast<const char*>(trans_offs.data()), \
+            trans_offs.size() * sizeof(std::uint64_t));
+
+        pad_to(header.m_weights_offs);
+        file.write(reinterpret_cast<const char*>(trans_weights.data()), \
+            trans_weights.size() * sizeof(std::uint64_t));
+
+        pad_to(header.m_pool_offs);
+        for (std::size_t tt = 0; tt < trans; tt++)
+            file.write(reinterpret_cast<const char*>(mmn_trans_ctx->m_trans[tt].m_v), \
+                mmn_trans_ctx->m_trans[tt].m_items * sizeof(MMN_ITEM_ID));
+
+        return file.good();
+    }
+
+    static bool is_trans_cache(const mm_mapped_file& file) {
+        return (file.size() >= sizeof(MMN_CACHE_HEADER)) && \
+            (std::memcmp(file.data(), g_cache_magic, sizeof(MMN_CACHE_HEADER::m_magic)) == 0);
+    }
+
+    // validates a cache and takes over its item dictionary
+    const MMN_CACHE_HEADER* open_trans_cache(const mm_mapped_file& file)
+    {
+        if (is_trans_cache(file) == false) return nullptr;
+
+        const MMN_CACHE_HEADER* header = \
+            reinterpret_cast<const MMN_CACHE_HEADER*>(file.data());
+
+        if ((header->m_version != g_cache_version) || \
+            (header->m_byte_order != g_cache_byte_order) || \
+            (header->m_pool_offs + header->m_pool_size * sizeof(MMN_ITEM_ID) > file.size()))
+            return nullptr;
+
+        const std::uint64_t* items_offs = \
+            reinterpret_cast<const std::uint64_t*>(file.data() + header->m_items_offs);
+
+        m_items.clear(); m_items_dict.clear();
+        for (std::size_t ii = 0; ii < header->m_items_cnt; ii++)
+        {
+            MMN_ITEM item = { const_cast<char*>(file.data() + header->m_chars_offs + items_offs[ii]), \
+                static_cast<std::size_t>(items_offs[ii + 1] - items_offs[ii] - 1) };
+
+            m_items_dict.emplace(std::string_view(item.m_buf, item.m_size), \
+                static_cast<MMN_ITEM_ID>(m_items.size()));
+            m_items.push_back(item);
+        }
+
+        m_item_max_len = header->m_item_max_len;
+
+        return header;
+    }
+
+    // builds the context of the transactions [trans_first, trans_last) of an opened cache
+    void load_trans_cache(const mm_mapped_file& file, \
+        const std::size_t trans_first, const std::size_t trans_last, \
+        MMN_TRANS_CONTEXT*& mmn_trans_ctx, sycl_usm_alloc_helper& usm_alloc)
+    {
+        const MMN_CACHE_HEADER* header = \
+            reinterpret_cast<const MMN_CACHE_HEADER*>(file.data());
+        const std::uint64_t* trans_offs = \
+            reinterpret_cast<const std::uint64_t*>(file.data() + header->m_trans_offs);
+        const std::uint64_t* trans_weights = \
+            reinterpret_cast<const std::uint64_t*>(file.data() + header->m_weights_offs);
+        MMN_ITEM_ID* trans_pool = reinterpret_cast<MMN_ITEM_ID*>(\
+            const_cast<char*>(file.data() + header->m_pool_offs));
+
+        const std::size_t trans = trans_last - trans_first;
+
+        MMN_TRANS* trans_buf = nullptr;
+        usm_alloc.alloc_buffer<MMN_TRANS>(trans_buf, trans);
+
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, trans), \
+            [&](const tbb::blocked_range<std::size_t>& r) {
+                for (std::size_t tt = r.begin(); tt != r.end(); tt++)
+                {
+                    std::size_t cache_tt = trans_first + tt;
+                    trans_buf[tt].m_v = trans_pool + trans_offs[cache_tt];
+                    trans_buf[tt].m_items = trans_offs[cache_tt + 1] - trans_offs[cache_tt];
+                    trans_buf[tt].m_weight = trans_weights[cache_tt];
+                }
+            });
+
+        MMN_TRANS_STATS stats;
+        stats.m_trans_cnt = trans;
+        stats.m_items_cnt = m_items.size();
+        stats.m_item_max_len = m_item_max_len;
+        stats.m_trans_min_len = header->m_trans_min_len;
+        stats.m_trans_max_len = header->m_trans_max_len;
+
+        // a block of the cache has its own length range
+        if (trans < header->m_trans_cnt)
+        {
+            stats.m_trans_min_len = stats.m_trans_max_len = 0L;
+            for (std::size_t tt = 0; tt < trans; tt++) {
+                if ((stats.m_trans_min_len == 0L) || (trans_buf[tt].m_items < stats.m_trans_min_len))
+                    stats.m_trans_min_len = trans_buf[tt].m_items;
+                stats.m_trans_max_len = std::max(stats.m_trans_max_len, trans_buf[tt].m_items);
+            }
+        }
+
+        if ((mmn_trans_ctx == nullptr) && \
+            (m_items.empty() == false) && (trans_buf != nullptr)) {
+            usm_alloc.alloc_trans_ctx(mmn_trans_ctx, items_snapshot(usm_alloc), trans_buf, stats);
+            mmn_trans_ctx->m_trans_pool = trans_pool + trans_offs[trans_first];
+        }
+    }
+
+private:
+    void load_trans(const char* data, const std::size_t size, \
+        MMN_TRANS_CONTEXT*& mmn_trans_ctx, sycl_usm_alloc_helper& usm_alloc)
+    {
+        std::size_t trans = 0L;
+        std::size_t pool_size = 0L;
+        std::size_t trans_min_len = 0L;
+        std::size_t trans_max_len = 0L;
+
+        MMN_TRANS* trans_buf = nullptr;
+        MMN_ITEM_ID* trans_pool = nullptr;
+        sycl_usm_alloc_helper items_alloc( \
+            "mm_model buffers", m_alloc_type, &m_arena);
+
+        auto mp = tbb::global_control::max_allowed_parallelism;
+        tbb::global_control gc(mp, mm_topology::threads());
+
+        std::vector<mm_load_chunk> chunks;
+        split_chunks(data, size, chunks);
+
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chunks.size()), \
+            [&](const tbb::blocked_range<std::size_t>& r) {
+                for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+                    parse_chunk(chunks[ii]);
+            });
+
+        // chunks are merged in file order, so item IDs follow the first occurrence of each item
+        for (auto& chunk : chunks)
+        {
+            chunk.m_trans_first = trans;
+            chunk.m_pool_first = pool_size;
+            chunk.m_remap.resize(chunk.m_items.size());
+
+            for (std::size_t ii = 0; ii < chunk.m_items.size(); ii++)
+            {
+                auto dict_it = m_items_dict.find(chunk.m_items[ii]);
+                if (dict_it == m_items_dict.end())
+                {
+                    // the dictionary keys point into the model's own copies of the item strings
+                    MMN_ITEM item = { nullptr, chunk.m_items[ii].size() };
+                    items_alloc.alloc_buffer<char>(item.m_buf, item.m_size + 1);
+                    usm_string_helper::strcpy(item.m_buf, item.m_size + 1, \
+                        chunk.m_items[ii].data(), chunk.m_items[ii].size());
+
+                    dict_it = m_items_dict.emplace(std::string_view(item.m_buf, item.m_size), \
+                        static_cast<MMN_ITEM_ID>(m_items.size())).first;
+
+                    m_items.push_back(item);
+                    m_item_max_len = std::max(m_item_max_len, item.m_size);
+                }
+
+                chunk.m_remap[ii] = dict_it->second;
+            }
+
+            if ((chunk.m_lens.size() > 0L) && \
+                ((chunk.m_len_min < trans_min_len) || (trans_min_len == 0L)))
+                trans_min_len = chunk.m_len_min;
+
+            trans_max_len = std::max(trans_max_len, chunk.m_len_max);
+
+            trans += chunk.m_lens.size();
+            pool_size += chunk.m_ids.size();
+        }
+
+        usm_alloc.alloc_buffer<MMN_TRANS>(trans_buf, trans);
+        usm_alloc.alloc_buffer<MMN_ITEM_ID>(trans_pool, pool_size);
+
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chunks.size()), \
+            [&](const tbb::blocked_range<std::size_t>& r) {
+                for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+                {
+                    const mm_load_chunk& chunk = chunks[ii];
+                    MMN_ITEM_ID* pool_ptr = trans_pool + chunk.m_pool_first;
+                    for (std::size_t jj = 0; jj < chunk.m_ids.size(); jj++)
+                        pool_ptr[jj] = chunk.m_remap[chunk.m_ids[jj]];
+
+                    for (std::size_t tt = 0; tt < chunk.m_lens.size(); tt++) {
+                        mm_vector::sort_vec(pool_ptr, chunk.m_lens[tt]);
+                        trans_buf[chunk.m_trans_first + tt].m_v = pool_ptr;
+                        trans_buf[chunk.m_trans_first + tt].m_items = chunk.m_lens[tt];
+                        trans_buf[chunk.m_trans_first + tt].m_weight = 1L;
+                        pool_ptr += chunk.m_lens[tt];
+                    }
+                }
+            });
+
+        if (mmn_trans_ctx == nullptr)
+        {
+            MMN_TRANS_STATS stats;
+            stats.m_trans_cnt = trans;
+            stats.m_items_cnt = m_items.size();
+            stats.m_item_max_len  = m_item_max_len;
+            stats.m_trans_min_len = trans_min_len;
+            stats.m_trans_max_len = trans_max_len;
+
+            if ((m_items.empty() == false) && (trans_buf != nullptr)) {
+               usm_alloc.alloc_trans_ctx(mmn_trans_ctx, items_snapshot(usm_alloc), trans_buf, stats);
+               mmn_trans_ctx->m_trans_pool = trans_pool;
+            }
+        }
+    }
+
+    typedef struct {
+        const char* m_first;
+        const char* m_last;
+        std::size_t m_trans_first;
+        std::size_t m_pool_first;
+        std::size_t m_len_min;
+        std::size_t m_len_max;
+        std::vector<std::size_t> m_lens;
+        std::vector<MMN_ITEM_ID> m_ids;
+        std::vector<MMN_ITEM_ID> m_remap;
+        std::vector<std::string_view> m_items;
+    } mm_load_chunk;
+
+    static std::uint64_t cache_align(const std::uint64_t offs) {
+        return (offs + g_cache_align - 1) & ~std::uint64_t(g_cache_align - 1);
+    }
+
+    static void split_chunks(const char* data, \
+        const std::size_t size, std::vector<mm_load_chunk>& chunks)
+    {
+        std::size_t chunk_size = std::max<std::size_t>(\
+            g_load_chunk_min_size, size / (mm_topology::threads() * 4) + 1);
+
+        const char* first = data, *end = data + size;
+        while (first < end)
+        {
+            const char* last = first + std::min<std::size_t>(chunk_size, end - first);
+            while ((last < end) && (*(last - 1) != '\n')) last++;
+
+            mm_load_chunk chunk = {};
+            chunk.m_first = first;
+            chunk.m_last = last;
+            chunks.push_back(std::move(chunk));
+
+            first = last;
+        }
+    }
+
+    static void parse_chunk(mm_load_chunk& chunk)
+    {
+        std::size_t tti = 0L;
+        std::unordered_map<std::string_view, MMN_ITEM_ID> items_dict;
+
+        const char* token = chunk.m_first;
+        for (const char* pos = chunk.m_first; pos <= chunk.m_last; pos++)
+        {
+            bool is_eol = (pos == chunk.m_last) || (*pos == '\n');
+            if ((is_eol == true) || (*pos == ',') || (*pos == '\r'))
+            {
+                if (pos > token)
+                {
+                    std::string_view item(token, pos - token);
+                    auto dict_it = items_dict.emplace(item, \
+                        static_cast<MMN_ITEM_ID>(chunk.m_items.size()));
+
+                    if (dict_it.second == true)
+                        chunk.m_items.push_back(item);
+
+                    // an item repeated within one transaction is stored once
+                    const MMN_ITEM_ID* line_ids = chunk.m_ids.data() + (chunk.m_ids.size() - tti);
+                    if (std::find(line_ids, line_ids + tti, dict_it.first->second) == line_ids + tti) {
+                        chunk.m_ids.push_back(dict_it.first->second);
+                        tti++;
+                    }
+                }
+
+                if ((is_eol == true) && (tti > 0L))
+                {
+                    if ((tti < chunk.m_len_min) || (chunk.m_len_min == 0L))
+                        chunk.m_len_min = tti;
+                    if (tti > chunk.m_len_max)
+                        chunk.m_len_max = tti;
+
+                    chunk.m_lens.push_back(tti); tti = 0L;
+                }
+
+                token = pos + 1;
+            }
+        }
+    }
+
+private:
+    USM_ALLOC_TYPE	m_alloc_type;
+    sycl_usm_arena	m_arena;
+
+    std::size_t m_item_max_len = 0L;
+    std::vector<MMN_ITEM> m_items;
+    std::unordered_map<std::string_view, MMN_ITEM_ID> m_items_dict;
+    std::vector<std::unique_ptr<mm_mapped_file>> m_caches;
+};
@@ -0,0 +1,151 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <tbb/task_arena.h>
+#include <tbb/task_scheduler_observer.h>
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+constexpr std::size_t g_perf_events = 4;
+
+typedef struct {
+	std::uint64_t m_v[g_perf_events];
+} MMN_PERF_COUNTS;
+
+// hardware counters (cycles, instructions, last-level cache misses, branch misses) of every
+// thread that runs mining work, read through perf_event_open; each thread counts its own user
+// space in one event group, and a reading sums the groups, so a phase that runs next to others
+// (the partitions of mine_partitions) shares their counts unless the run has one thread
+class mm_perf
+{
+public:
+	static const char* event_name(const std::size_t event) {
+		static const char* names[g_perf_events] = { \
+			"cycles", "instructions", "llc_misses", "branch_misses" };
+		return names[event];
+	}
+
+	static bool enabled() {
+		return state().m_enabled.load(std::memory_order_relaxed);
+	}
+
+	// counts the calling thread and the workers of its implicit arena from now on;
+	// false when the kernel or the machine offers no counters
+	static bool enable()
+	{
+		if (attach_thread() == false)
+			return false;
+
+		// the observer is never destroyed, since the workers may outlive main
+		static arena_observer* observer = new arena_observer();
+		observer->observe(true);
+
+		state().m_enabled.store(true, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	// opens the counters of the calling thread, once per thread
+	static bool attach_thread()
+	{
+#if defined(__linux__)
+		thread_local bool is_attached = false;
+		if (is_attached == true) return true;
+
+		static const std::uint64_t configs[g_perf_events] = { PERF_COUNT_HW_CPU_CYCLES, \
+			PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+		int fds[g_perf_events] = { -1, -1, -1, -1 };
+		for (std::size_t ee = 0; ee < g_perf_events; ee++)
+		{
+			struct perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = configs[ee];
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP | \
+				PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+			fds[ee] = static_cast<int>(::syscall(__NR_perf_event_open, \
+				&attr, 0, -1, (ee > 0L) ? fds[0] : -1, 0UL));
+
+			if (fds[ee] < 0) {
+				for (std::size_t jj = 0; jj < ee; jj++) ::close(fds[jj]);
+				return false;
+			}
+		}
+
+		::ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+		std::lock_guard<std::mutex> lock(state().m_mutex);
+		state().m_groups.push_back(fds[0]);
+
+		is_attached = true;
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// the counts of all attached threads so far, scaled up where the
+	// kernel multiplexed the group with other events
+	static MMN_PERF_COUNTS read()
+	{
+		MMN_PERF_COUNTS counts = {};
+#if defined(__linux__)
+		std::lock_guard<std::mutex> lock(state().m_mutex);
+		for (int fd : state().m_groups)
+		{
+			std::uint64_t values[3 + g_perf_events] = {};
+			if ((::read(fd, values, sizeof(values)) != sizeof(values)) || (values[2] == 0L))
+				continue;
+
+			double scale = static_cast<double>(values[1]) / values[2];
+			for (std::size_t ee = 0; ee < g_perf_events; ee++)
+				counts.m_v[ee] += static_cast<std::uint64_t>(values[3 + ee] * scale);
+		}
+#endif
+		return counts;
+	}
+
+	// attaches the threads that join an arena, for the arenas created after enable()
+	class arena_observer : public tbb::task_scheduler_observer
+	{
+	public:
+		arena_observer() : tbb::task_scheduler_observer() {}
+		arena_observer(tbb::task_arena& arena) : tbb::task_scheduler_observer(arena) {}
+
+		void on_scheduler_entry(bool) override { attach_thread(); }
+	};
+
+private:
+	typedef struct {
+		std::atomic<bool> m_enabled;
+		std::mutex m_mutex;
+		std::vector<int> m_groups;
+	} MMN_PERF_STATE;
+
+	static MMN_PERF_STATE& state() {
+		static MMN_PERF_STATE perf_state{};
+		return perf_state;
+	}
+};
@@ -0,0 +1,177 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <ostream>
+#include <algorithm>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include "mm_perf.hpp"
+
+// the counters of one level, named after the level's candidate length: the joined
+// candidates, those left by each filter of gen_sub_nodes, the lookahead sets reported,
+// and the support evaluations with the transactions they cover
+typedef struct {
+	std::size_t m_generated;
+	std::size_t m_frequent;
+	std::size_t m_uncovered;
+	std::size_t m_lookahead;
+	std::size_t m_support_evals;
+	std::size_t m_trans_scanned;
+} MMN_PROFILE_LEVEL;
+
+typedef struct {
+	std::size_t m_calls;
+	std::chrono::nanoseconds m_wall;
+	MMN_PERF_COUNTS m_perf;
+} MMN_PROFILE_PHASE;
+
+// per-phase wall time and per-level counters, switched on at run time; while disabled
+// a timer and a counter update cost one relaxed load each, so the probes stay in place
+class mm_profile
+{
+public:
+	static bool enabled() {
+		return state().m_enabled.load(std::memory_order_relaxed);
+	}
+
+	static void enable(const bool enabled) {
+		state().m_enabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	// times a scope as a call of the phase, along with the hardware counters when they are on;
+	// a level of 0 is a phase of the whole run, phases that nest (filter_cands within
+	// gen_sub_nodes) are measured inclusively
+	class scope_timer
+	{
+	public:
+		scope_timer(const char* phase, const std::size_t level = 0L) : \
+			m_phase(phase), m_level(level), m_enabled(mm_profile::enabled()), m_perf_start{}
+		{
+			if (m_enabled == true) {
+				if (mm_perf::enabled() == true)
+					m_perf_start = mm_perf::read();
+				m_start = std::chrono::steady_clock::now();
+			}
+		}
+
+		virtual ~scope_timer()
+		{
+			if (m_enabled == false) return;
+
+			std::chrono::nanoseconds wall = std::chrono::steady_clock::now() - m_start;
+
+			MMN_PERF_COUNTS perf = {};
+			if (mm_perf::enabled() == true) {
+				perf = mm_perf::read();
+				for (std::size_t ee = 0; ee < g_perf_events; ee++)
+					perf.m_v[ee] -= std::min(perf.m_v[ee], m_perf_start.m_v[ee]);
+			}
+
+			mm_profile::add_phase(m_phase, m_level, wall, perf);
+		}
+
+		scope_timer(const scope_timer&) = delete;
+		scope_timer& operator=(const scope_timer&) = delete;
+
+	private:
+		const char* m_phase;
+		std::size_t m_level;
+		bool m_enabled;
+		MMN_PERF_COUNTS m_perf_start;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	static void add_phase(const char* phase, const std::size_t level, \
+		const std::chrono::nanoseconds wall, const MMN_PERF_COUNTS& perf)
+	{
+		std::lock_guard<std::mutex> lock(state().m_mutex);
+		MMN_PROFILE_PHASE& record = state().m_phases[std::make_pair(std::string(phase), level)];
+		record.m_calls++; record.m_wall += wall;
+		for (std::size_t ee = 0; ee < g_perf_events; ee++)
+			record.m_perf.m_v[ee] += perf.m_v[ee];
+	}
+
+	static void add_level(const std::size_t level, const MMN_PROFILE_LEVEL& counters)
+	{
+		if (enabled() == false) return;
+
+		std::lock_guard<std::mutex> lock(state().m_mutex);
+		MMN_PROFILE_LEVEL& record = state().m_levels[level];
+		record.m_generated += counters.m_generated;
+		record.m_frequent += counters.m_frequent;
+		record.m_uncovered += counters.m_uncovered;
+		record.m_lookahead += counters.m_lookahead;
+		record.m_support_evals += counters.m_support_evals;
+		record.m_trans_scanned += counters.m_trans_scanned;
+	}
+
+	static void write_report(std::ostream& os)
+	{
+		std::lock_guard<std::mutex> lock(state().m_mutex);
+
+		os << "{\n  \"hw_counters\": " << (mm_perf::enabled() ? "true" : "false");
+
+		os << ",\n  \"phases\": [";
+		for (auto it = state().m_phases.begin(); it != state().m_phases.end(); it++)
+		{
+			os << ((it != state().m_phases.begin()) ? "," : "") << "\n    { \"phase\": \"" \
+				<< it->first.first << "\", \"level\": " << it->first.second << ", \"calls\": " \
+				<< it->second.m_calls << ", \"wall_ms\": " \
+				<< std::chrono::duration<double, std::milli>(it->second.m_wall).count();
+
+			for (std::size_t ee = 0; (mm_perf::enabled() == true) && (ee < g_perf_events); ee++)
+				os << ", \"" << mm_perf::event_name(ee) << "\": " << it->second.m_perf.m_v[ee];
+
+			os << " }";
+		}
+
+		os << "\n  ],\n  \"levels\": [";
+		for (auto it = state().m_levels.begin(); it != state().m_levels.end(); it++)
+			os << ((it != state().m_levels.begin()) ? "," : "") << "\n    { \"level\": " \
+				<< it->first << ", \"generated\": " << it->second.m_generated \
+				<< ", \"frequent\": " << it->second.m_frequent \
+				<< ", \"uncovered\": " << it->second.m_uncovered \
+				<< ", \"lookahead\": " << it->second.m_lookahead \
+				<< ", \"support_evals\": " << it->second.m_support_evals \
+				<< ", \"trans_scanned\": " << it->second.m_trans_scanned << " }";
+
+		os << "\n  ],\n  \"peak_rss_kb\": " << peak_rss_kb() << "\n}\n";
+	}
+
+private:
+	typedef struct {
+		std::atomic<bool> m_enabled;
+		std::mutex m_mutex;
+		std::map<std::pair<std::string, std::size_t>, MMN_PROFILE_PHASE> m_phases;
+		std::map<std::size_t, MMN_PROFILE_LEVEL> m_levels;
+	} MMN_PROFILE_STATE;
+
+	static MMN_PROFILE_STATE& state() {
+		static MMN_PROFILE_STATE profile_state{};
+		return profile_state;
+	}
+
+	static long peak_rss_kb()
+	{
+#if !defined(_WIN32)
+		struct rusage usage = {};
+		if (::getrusage(RUSAGE_SELF, &usage) == 0)
+			return static_cast<long>(usage.ru_maxrss);
+#endif
+		return 0L;
+	}
+};
@@ -0,0 +1,154 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "mm_types.hpp"
+#include "mm_vector.hpp"
+#include "usm_alloc.hpp"
+#include "mm_profile.hpp"
+
+constexpr std::size_t g_reduce_min_len = 2;
+
+class mm_reduce
+{
+public:
+	// builds, in the arena, a counting copy of the context: the items that are not among the
+	// frequent 1-item candidates are projected out of every transaction, the transactions left
+	// shorter than any joined candidate are dropped, and identical transactions are merged into
+	// one record weighted by their count; the source keeps its rows, which the partitions are cut from
+	static void reduce_trans(const MMN_TRANS_CONTEXT* trans_ctx, MMN_TRANS_CONTEXT*& reduced_ctx, \
+		const MMN_RULE* cnds_buf, const std::size_t cnds, sycl_usm_arena& arena)
+	{
+		mm_profile::scope_timer timer("reduce_trans");
+
+		sycl_usm_alloc_helper usm_alloc(\
+			"mm_reduce buffers", USM_ALLOC_TYPE::usm_alloc_crt, &arena);
+
+		reduced_ctx = nullptr;
+
+		const std::size_t trans = trans_ctx->m_stats.m_trans_cnt;
+		if (trans == 0L) return;
+
+		std::vector<bool> items_keep(trans_ctx->m_stats.m_items_cnt, false);
+		for (std::size_t ii = 0; ii < cnds; ii++)
+			if (cnds_buf[ii].m_items == 1L)
+				items_keep[cnds_buf[ii].m_v[0]] = true;
+
+		std::vector<std::size_t> trans_offs(trans + 1, 0L);
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, trans), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t tt = r.begin(); tt != r.end(); tt++)
+				{
+					std::size_t len = 0L;
+					for (std::size_t jj = 0; jj < trans_ctx->m_trans[tt].m_items; jj++)
+						len += items_keep[trans_ctx->m_trans[tt].m_v[jj]];
+
+					trans_offs[tt] = (len >= g_reduce_min_len) ? len : 0L;
+				}
+			});
+
+		std::size_t pool_size = 0L;
+		for (std::size_t tt = 0; tt <= trans; tt++) {
+			std::size_t len = trans_offs[tt];
+			trans_offs[tt] = pool_size; pool_size += len;
+		}
+
+		MMN_ITEM_ID* pool_buf = nullptr;
+		usm_alloc.alloc_buffer<MMN_ITEM_ID>(pool_buf, pool_size);
+
+		// projected transactions stay sorted, since items keep their relative order
+		std::vector<std::uint64_t> trans_hash(trans, 0L);
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, trans), \
+			[&](const tbb::blocked_range<std::size_t>& r) {
+				for (std::size_t tt = r.begin(); tt != r.end(); tt++)
+				{
+					MMN_ITEM_ID* trans_v = pool_buf + trans_offs[tt];
+					if (trans_offs[tt + 1] == trans_offs[tt]) continue;
+
+					for (std::size_t jj = 0, kk = 0; jj < trans_ctx->m_trans[tt].m_items; jj++)
+						if (items_keep[trans_ctx->m_trans[tt].m_v[jj]] == true)
+							trans_v[kk++] = trans_ctx->m_trans[tt].m_v[jj];
+
+					trans_hash[tt] = mm_vector::hash_vec(trans_v, trans_offs[tt + 1] - trans_offs[tt]);
+				}
+			});
+
+		auto trans_len = [&](const std::size_t tt) {
+			return trans_offs[tt + 1] - trans_offs[tt];
+		};
+
+		std::vector<std::size_t> trans_order;
+		for (std::size_t tt = 0; tt < trans; tt++)
+			if (trans_len(tt) > 0L) trans_order.push_back(tt);
+
+		// equal transactions become neighbours, the first occurrence leading its group
+		tbb::parallel_sort(trans_order.begin(), trans_order.end(), \
+			[&](const std::size_t t1, const std::size_t t2) {
+				if (trans_hash[t1] != trans_hash[t2])
+					return trans_hash[t1] < trans_hash[t2];
+
+				int cmp = mm_vector::compare_vec(pool_buf + trans_offs[t1], trans_len(t1), \
+					pool_buf + trans_offs[t2], trans_len(t2));
+
+				return (cmp != 0) ? (cmp < 0) : (t1 < t2);
+			});
+
+		std::vector<std::size_t> trans_weight(trans, 0L);
+		for (std::size_t ii = 0, first = 0; ii < trans_order.size(); ii++)
+		{
+			std::size_t tt = trans_order[ii], tt_first = trans_order[first];
+			bool is_equal = (trans_hash[tt] == trans_hash[tt_first]) && \
+				mm_vector::is_equal_vec(pool_buf + trans_offs[tt], trans_len(tt), \
+					pool_buf + trans_offs[tt_first], trans_len(tt_first));
+
+			if (is_equal == false) {
+				first = ii; tt_first = tt;
+			}
+
+			trans_weight[tt_first] += trans_ctx->m_trans[tt].m_weight;
+		}
+
+		// records keep the file order of their first occurrence
+		std::size_t records = 0L;
+		for (std::size_t tt = 0; tt < trans; tt++)
+			records += (trans_weight[tt] > 0L);
+
+		MMN_TRANS* trans_buf = nullptr;
+		usm_alloc.alloc_buffer<MMN_TRANS>(trans_buf, records);
+
+		std::size_t trans_min_len = 0L, trans_max_len = 0L;
+		for (std::size_t tt = 0, rr = 0; tt < trans; tt++)
+			if (trans_weight[tt] > 0L)
+			{
+				trans_buf[rr].m_v = pool_buf + trans_offs[tt];
+				trans_buf[rr].m_items = trans_len(tt);
+				trans_buf[rr].m_weight = trans_weight[tt];
+
+				if ((trans_min_len == 0L) || (trans_len(tt) < trans_min_len))
+					trans_min_len = trans_len(tt);
+				trans_max_len = std::max(trans_max_len, trans_len(tt));
+
+				rr++;
+			}
+
+		MMN_TRANS_STATS stats = trans_ctx->m_stats;
+		stats.m_trans_cnt = records;
+		stats.m_trans_min_len = trans_min_len;
+		stats.m_trans_max_len = trans_max_len;
+
+		usm_alloc.alloc_trans_ctx(reduced_ctx, trans_ctx->m_items, trans_buf, stats);
+		if (reduced_ctx != nullptr)
+			reduced_ctx->m_trans_pool = pool_buf;
+	}
+};
@@ -0,0 +1,75 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "mm_types.hpp"
+#include "mm_vector.hpp"
+
+class mm_store
+{
+public:
+	static MMN_ITEM_ID* items(const MMN_CNDS_STORE& cnds_store, const std::size_t cnd) {
+		return cnds_store.m_pool + cnds_store.m_offs[cnd];
+	}
+
+	// candidates keep their items in search order, tries and rules take them sorted
+	static void sorted_items(const MMN_CNDS_STORE& cnds_store, \
+		const std::size_t cnd, std::vector<MMN_ITEM_ID>& items_buf)
+	{
+		items_buf.assign(items(cnds_store, cnd), \
+			items(cnds_store, cnd) + cnds_store.m_items[cnd]);
+		mm_vector::sort_vec(items_buf.data(), items_buf.size());
+	}
+
+	static std::size_t pool_size(const MMN_RULE* rules_buf, const std::size_t rules)
+	{
+		std::size_t pool_size = 0L;
+		for (std::size_t ii = 0; ii < rules; ii++)
+			pool_size += rules_buf[ii].m_items;
+
+		return pool_size;
+	}
+
+	// copies candidate cnd_src into slot cnd_dst, whose items start at pool_offs
+	static void copy_cnd(const MMN_CNDS_STORE& cnds_src, const std::size_t cnd_src, \
+		const MMN_CNDS_STORE& cnds_dst, const std::size_t cnd_dst, const std::size_t pool_offs)
+	{
+		const MMN_ITEM_ID* items_src = items(cnds_src, cnd_src);
+		for (std::size_t ii = 0; ii < cnds_src.m_items[cnd_src]; ii++)
+			cnds_dst.m_pool[pool_offs + ii] = items_src[ii];
+
+		cnds_dst.m_offs[cnd_dst] = pool_offs;
+		cnds_dst.m_items[cnd_dst] = cnds_src.m_items[cnd_src];
+		cnds_dst.m_conf[cnd_dst] = cnds_src.m_conf[cnd_src];
+		cnds_dst.m_supp_a[cnd_dst] = cnds_src.m_supp_a[cnd_src];
+		cnds_dst.m_supp_b[cnd_dst] = cnds_src.m_supp_b[cnd_src];
+		cnds_dst.m_supp_ab[cnd_dst] = cnds_src.m_supp_ab[cnd_src];
+	}
+
+	static void from_rules(const MMN_RULE* rules_buf, \
+		const std::size_t rules, MMN_CNDS_STORE& cnds_dst)
+	{
+		std::size_t pool_offs = 0L;
+		for (std::size_t ii = 0; ii < rules; ii++)
+		{
+			std::memcpy(cnds_dst.m_pool + pool_offs, rules_buf[ii].m_v, \
+				rules_buf[ii].m_items * sizeof(MMN_ITEM_ID));
+
+			cnds_dst.m_offs[ii] = pool_offs;
+			cnds_dst.m_items[ii] = rules_buf[ii].m_items;
+			cnds_dst.m_conf[ii] = rules_buf[ii].m_conf;
+			cnds_dst.m_supp_a[ii] = rules_buf[ii].m_supp_a;
+			cnds_dst.m_supp_b[ii] = rules_buf[ii].m_supp_b;
+			cnds_dst.m_supp_ab[ii] = rules_buf[ii].m_supp_ab;
+
+			pool_offs += rules_buf[ii].m_items;
+		}
+	}
+};
@@ -0,0 +1,153 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include "mm_types.hpp"
+#include "mm_mmap.hpp"
+#include "mm_model.hpp"
+#include "mm_bitmap.hpp"
+#include "usm_alloc.hpp"
+
+// a parsed block (transactions, reduced copy and tidset index) takes up to
+// this many times the bytes of its text
+constexpr std::size_t g_stream_block_ratio = 8;
+
+// reads a transaction file (or its binary cache) that does not fit in memory in blocks,
+// sized so that one parsed block stays within the memory budget; only the item
+// dictionary and the candidates outlive a block
+class mm_stream_reader
+{
+public:
+	mm_stream_reader(const char* filename, const std::size_t mem_budget, mm_model& model) : \
+		m_file(filename), m_model(model), m_arena("mm_stream buffers"), m_cache(nullptr), \
+			m_block(0L), m_block_ctx(nullptr)
+	{
+		if (m_file.is_open() == false) {
+			std::cerr << "Unable to read file: " << filename << "\n";
+			exit(1);
+		}
+
+		std::size_t block_size = std::max<std::size_t>(1L, mem_budget / g_stream_block_ratio);
+
+		if (mm_model::is_trans_cache(m_file) == true)
+		{
+			m_cache = m_model.open_trans_cache(m_file);
+			if (m_cache == nullptr) {
+				std::cerr << "Error: (mm_stream) unsupported cache file: " << filename << "\n";
+				exit(1);
+			}
+
+			split_cache_blocks(block_size);
+		}
+
+		else split_text_blocks(block_size);
+	}
+
+	virtual ~mm_stream_reader() { release_block(); }
+
+	mm_stream_reader(const mm_stream_reader&) = delete;
+	mm_stream_reader& operator=(const mm_stream_reader&) = delete;
+
+public:
+	std::size_t blocks() const { return m_blocks.size(); }
+
+	mm_model& model() { return m_model; }
+
+	// buffers derived from the current block are released together with it
+	sycl_usm_arena& block_arena() { return m_arena; }
+
+	// the context of a block is valid until the next block is loaded,
+	// and is null for a block without transactions
+	MMN_TRANS_CONTEXT* load_block(const std::size_t block)
+	{
+		release_block();
+
+		m_block = block;
+		if (m_cache != nullptr)
+		{
+			sycl_usm_alloc_helper usm_alloc(\
+				"mm_stream buffers", USM_ALLOC_TYPE::usm_alloc_crt, &m_arena);
+			m_model.load_trans_cache(m_file, m_blocks[block].first, \
+				m_blocks[block].second, m_block_ctx, usm_alloc);
+		}
+
+		else m_model.load_trans_block(m_file.data() + m_blocks[block].first, \
+			m_blocks[block].second, m_block_ctx, m_arena);
+
+		return m_block_ctx;
+	}
+
+private:
+	// text blocks are byte ranges (offset, size) of whole lines
+	void split_text_blocks(const std::size_t block_size)
+	{
+		const char* first = m_file.data(), *end = m_file.data() + m_file.size();
+		while (first < end)
+		{
+			const char* last = first + std::min<std::size_t>(block_size, end - first);
+			while ((last < end) && (*(last - 1) != '\n')) last++;
+
+			m_blocks.push_back(std::make_pair(\
+				std::size_t(first - m_file.data()), std::size_t(last - first)));
+
+			first = last;
+		}
+	}
+
+	// cache blocks are transaction ranges [first, last) of about block_size bytes
+	void split_cache_blocks(const std::size_t block_size)
+	{
+		const std::uint64_t* trans_offs = cache_trans_offs();
+
+		std::size_t first = 0L, bytes = 0L;
+		for (std::size_t tt = 0; tt < m_cache->m_trans_cnt; tt++)
+		{
+			bytes += (trans_offs[tt + 1] - trans_offs[tt]) * \
+				sizeof(MMN_ITEM_ID) + 2 * sizeof(std::uint64_t);
+
+			if ((bytes >= block_size) || (tt + 1 == m_cache->m_trans_cnt)) {
+				m_blocks.push_back(std::make_pair(first, tt + 1));
+				first = tt + 1; bytes = 0L;
+			}
+		}
+	}
+
+	const std::uint64_t* cache_trans_offs() const {
+		return reinterpret_cast<const std::uint64_t*>(m_file.data() + m_cache->m_trans_offs);
+	}
+
+	void release_block()
+	{
+		if (m_block_ctx != nullptr) {
+			mm_bitmap::free_index(m_block_ctx->m_tidsets);
+			if (m_cache != nullptr) {
+				const std::uint64_t* trans_offs = cache_trans_offs();
+				std::size_t pool_first = trans_offs[m_blocks[m_block].first] * sizeof(MMN_ITEM_ID);
+				std::size_t pool_last = trans_offs[m_blocks[m_block].second] * sizeof(MMN_ITEM_ID);
+				m_file.discard(m_cache->m_pool_offs + pool_first, pool_last - pool_first);
+			}
+
+			else m_file.discard(m_blocks[m_block].first, m_blocks[m_block].second);
+		}
+
+		m_arena.reset(); m_block_ctx = nullptr;
+	}
+
+private:
+	mm_mapped_file		m_file;
+	mm_model&			m_model;
+	sycl_usm_arena		m_arena;
+	const MMN_CACHE_HEADER* m_cache;
+
+	std::size_t			m_block;
+	MMN_TRANS_CONTEXT*	m_block_ctx;
+	std::vector<std::pair<std::size_t, std::size_t>> m_blocks;
+};
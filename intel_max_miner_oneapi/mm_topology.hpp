@@ -0,0 +1,118 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <tbb/info.h>
+#include <tbb/task_arena.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <fstream>
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
+
+class mm_topology
+{
+public:
+	// the worker threads of a run: the override when one is set, otherwise the CPUs the
+	// process may run on, capped by the CPU quota of its cgroup
+	static std::size_t threads()
+	{
+		static const std::size_t threads_detected = detect_threads();
+		return (threads_override() > 0L) ? threads_override() : threads_detected;
+	}
+
+	static void set_threads(const std::size_t threads) {
+		threads_override() = threads;
+	}
+
+	// one arena per NUMA node, limited to the node's CPUs; a single unconstrained
+	// arena when the machine has one node or the topology is unknown
+	static void numa_arenas(std::vector<std::unique_ptr<tbb::task_arena>>& arenas)
+	{
+		std::vector<tbb::numa_node_id> nodes = tbb::info::numa_nodes();
+
+		arenas.clear();
+		for (std::size_t nn = 0; (nodes.size() > 1L) && (nn < nodes.size()); nn++)
+		{
+			std::size_t node_threads = std::max<std::size_t>(1L, \
+				threads() * tbb::info::default_concurrency(nodes[nn]) / total_concurrency(nodes));
+
+			arenas.emplace_back(new tbb::task_arena(tbb::task_arena::constraints(\
+				nodes[nn], static_cast<int>(node_threads))));
+		}
+
+		if (arenas.empty() == true)
+			arenas.emplace_back(new tbb::task_arena(static_cast<int>(threads())));
+	}
+
+private:
+	static std::size_t& threads_override() {
+		static std::size_t threads = 0L;
+		return threads;
+	}
+
+	static std::size_t total_concurrency(const std::vector<tbb::numa_node_id>& nodes)
+	{
+		std::size_t concurrency = 0L;
+		for (auto node : nodes)
+			concurrency += tbb::info::default_concurrency(node);
+
+		return std::max<std::size_t>(1L, concurrency);
+	}
+
+	static std::size_t detect_threads()
+	{
+		std::size_t threads = std::max(1U, std::thread::hardware_concurrency());
+#if defined(_WIN32)
+		// counts the processors of every group, beyond the first 64
+		threads = std::max<std::size_t>(1L, ::GetActiveProcessorCount(ALL_PROCESSOR_GROUPS));
+#else
+		cpu_set_t cpu_set;
+		CPU_ZERO(&cpu_set);
+		if (::sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0)
+			threads = std::max(1, CPU_COUNT(&cpu_set));
+
+		double quota = cgroup_cpu_quota();
+		if (quota > .0f)
+			threads = std::min(threads, \
+				std::max<std::size_t>(1L, static_cast<std::size_t>(std::ceil(quota))));
+#endif
+		return threads;
+	}
+
+#if !defined(_WIN32)
+	// CPUs granted by the cgroup (v2 cpu.max or v1 CFS quota and period), 0 when unlimited
+	static double cgroup_cpu_quota()
+	{
+		std::string quota; double period = .0f;
+		std::ifstream cpu_max("/sys/fs/cgroup/cpu.max");
+		if (cpu_max >> quota >> period)
+			return ((quota != "max") && (period > .0f)) ? std::stod(quota) / period : .0f;
+
+		double quota_us = .0f, period_us = .0f;
+		std::ifstream cfs_quota("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+		std::ifstream cfs_period("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+		if ((cfs_quota >> quota_us) && (cfs_period >> period_us) && \
+			(quota_us > .0f) && (period_us > .0f))
+			return quota_us / period_us;
+
+		return .0f;
+	}
+#endif
+};
@@ -0,0 +1,128 @@
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "mm_types.hpp"
+
+constexpr std::size_t g_trie_no_node = \
+	std::numeric_limits<std::size_t>::max();
+
+// set-enumeration (MFI) tree over canonical itemsets: every stored itemset is a
+// root path, and siblings are kept in ascending item order, so subset queries
+// only descend into branches that can still contain the remaining items
+class mm_itemset_trie
+{
+public:
+	mm_itemset_trie() { clear(); }
+	virtual ~mm_itemset_trie() {}
+
+public:
+	void clear() {
+		m_nodes.clear(); m_sets = 0L;
+		m_nodes.push_back({ 0, g_trie_no_node, g_trie_no_node, 0L, false });
+	}
+
+	std::size_t size() const { return m_sets; }
+
+	void insert(const MMN_ITEM_ID* items_buf, const std::size_t items_size)
+	{
+		std::size_t node = 0L;
+		for (std::size_t ii = 0; ii < items_size; ii++)
+		{
+			m_nodes[node].m_height = std::max(m_nodes[node].m_height, items_size - ii);
+
+			std::size_t prev = g_trie_no_node, child = m_nodes[node].m_child;
+			while ((child != g_trie_no_node) && (m_nodes[child].m_item < items_buf[ii])) {
+				prev = child; child = m_nodes[child].m_next;
+			}
+
+			if ((child == g_trie_no_node) || (m_nodes[child].m_item != items_buf[ii]))
+			{
+				std::size_t next = child;
+				child = m_nodes.size();
+				m_nodes.push_back({ items_buf[ii], g_trie_no_node, next, 0L, false });
+
+				if (prev != g_trie_no_node)
+					m_nodes[prev].m_next = child;
+				else m_nodes[node].m_child = child;
+			}
+
+			node = child;
+		}
+
+		if (m_nodes[node].m_last == false) {
+			m_nodes[node].m_last = true; m_sets++;
+		}
+	}
+
+	// is the itemset contained in (or equal to) any stored itemset
+	bool has_superset(const MMN_ITEM_ID* items_buf, const std::size_t items_size) const {
+		return has_superset(0L, items_buf, items_size);
+	}
+
+	// is any stored itemset contained in (or equal to) the itemset
+	bool has_subset(const MMN_ITEM_ID* items_buf, const std::size_t items_size) const {
+		return has_subset(0L, items_buf, items_size);
+	}
+
+private:
+	bool has_superset(const std::size_t node, \
+		const MMN_ITEM_ID* items_buf, const std::size_t items_size) const
+	{
+		if (items_size == 0L) return true;
+		if (m_nodes[node].m_height < items_size) return false;
+
+		for (std::size_t child = m_nodes[node].m_child; child != g_trie_no_node; \
+			child = m_nodes[child].m_next)
+		{
+			// the subtree of a larger item cannot hold items_buf[0] anymore
+			if (m_nodes[child].m_item > items_buf[0]) break;
+
+			bool found = (m_nodes[child].m_item == items_buf[0]) ? \
+				has_superset(child, items_buf + 1, items_size - 1) : \
+				has_superset(child, items_buf, items_size);
+
+			if (found == true) return true;
+		}
+
+		return false;
+	}
+
+	bool has_subset(const std::size_t node, \
+		const MMN_ITEM_ID* items_buf, const std::size_t items_size) const
+	{
+		if (m_nodes[node].m_last == true) return true;
+
+		std::size_t ii = 0L;
+		for (std::size_t child = m_nodes[node].m_child; \
+			(child != g_trie_no_node) && (ii < items_size); child = m_nodes[child].m_next)
+		{
+			while ((ii < items_size) && (items_buf[ii] < m_nodes[child].m_item)) ii++;
+			if ((ii < items_size) && (items_buf[ii] == m_nodes[child].m_item) && \
+				(has_subset(child, items_buf + ii + 1, items_size - ii - 1) == true))
+				return true;
+		}
+
+		return false;
+	}
+
+private:
+	typedef struct {
+		MMN_ITEM_ID m_item;
+		std::size_t m_child;
+		std::size_t m_next;
+		std::size_t m_height;
+		bool m_last;
+	} MMN_TRIE_NODE;
+
+	std::vector<MMN_TRIE_NODE> m_nodes;
+	std::size_t m_sets;
+};
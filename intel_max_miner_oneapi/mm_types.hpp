@@ -1,44 +1,95 @@
-//==============================================================
-// Copyright  2020 Intel Corporation
-//
-// SPDX-License-Identifier: MIT
-// =============================================================
-
-#pragma once
-
-#include <string>
-#include <fstream>
-#include <iostream>
-
-typedef struct {
-    char* m_buf;
-    std::size_t m_size;
-} MMN_ITEM;
-
-typedef struct {
-    MMN_ITEM* m_v;
-    std::size_t m_items;
-} MMN_TRANS;
-
-typedef struct {
-    MMN_ITEM* m_v;
-    double m_conf;
-    double m_supp_a;
-    double m_supp_b;
-    double m_supp_ab;
-    std::size_t m_items;
-} MMN_RULE;
-
-typedef struct {
-    std::size_t m_trans_cnt;
-    std::size_t m_items_cnt;
-    std::size_t m_item_max_len;
-    std::size_t m_trans_min_len;
-    std::size_t m_trans_max_len;
-} MMN_TRANS_STATS;
-
-typedef struct {
-    MMN_ITEM* m_items;
-    MMN_TRANS* m_trans;
-    MMN_TRANS_STATS m_stats;
-} MMN_TRANS_CONTEXT;
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+typedef std::uint32_t MMN_ITEM_ID;
+
+typedef struct {
+    char* m_buf;
+    std::size_t m_size;
+} MMN_ITEM;
+
+typedef struct {
+    MMN_ITEM_ID* m_v;
+    std::size_t m_items;
+    std::size_t m_weight;
+} MMN_TRANS;
+
+typedef struct {
+    MMN_ITEM_ID* m_v;
+    double m_conf;
+    double m_supp_a;
+    double m_supp_b;
+    double m_supp_ab;
+    std::size_t m_items;
+    // positions in m_v of the items that the two join parents (supp_a, supp_b) leave out
+    std::size_t m_parent_a;
+    std::size_t m_parent_b;
+} MMN_RULE;
+
+// a candidate level: candidate i owns m_pool[m_offs[i] .. m_offs[i] + m_items[i])
+typedef struct {
+    MMN_ITEM_ID* m_pool;
+    std::size_t* m_offs;
+    std::size_t* m_items;
+    double* m_conf;
+    double* m_supp_a;
+    double* m_supp_b;
+    double* m_supp_ab;
+    std::size_t m_cnds;
+    std::size_t m_pool_size;
+} MMN_CNDS_STORE;
+
+typedef struct {
+    std::size_t m_trans_cnt;
+    std::size_t m_items_cnt;
+    std::size_t m_item_max_len;
+    std::size_t m_trans_min_len;
+    std::size_t m_trans_max_len;
+} MMN_TRANS_STATS;
+
+typedef struct {
+    MMN_ITEM_ID* m_rows;
+    std::uint64_t* m_bits;
+    std::uint64_t* m_weights;
+    std::size_t m_items;
+    std::size_t m_words;
+    std::size_t m_planes;
+} MMN_TIDSET_INDEX;
+
+// header of the binary cache of a transaction context; the sections follow it, each
+// aligned to 64 bytes: item string offsets, NUL-terminated item strings, transaction
+// offsets into the pool, transaction weights and the pool of item IDs
+typedef struct {
+    char m_magic[8];
+    std::uint32_t m_version;
+    std::uint32_t m_byte_order;
+    std::uint64_t m_trans_cnt;
+    std::uint64_t m_items_cnt;
+    std::uint64_t m_item_max_len;
+    std::uint64_t m_trans_min_len;
+    std::uint64_t m_trans_max_len;
+    std::uint64_t m_pool_size;
+    std::uint64_t m_items_offs;
+    std::uint64_t m_chars_offs;
+    std::uint64_t m_trans_offs;
+    std::uint64_t m_weights_offs;
+    std::uint64_t m_pool_offs;
+} MMN_CACHE_HEADER;
+
+typedef struct {
+    MMN_ITEM* m_items;
+    MMN_TRANS* m_trans;
+    MMN_ITEM_ID* m_trans_pool;
+    MMN_TRANS_STATS m_stats;
+    MMN_TIDSET_INDEX* m_tidsets;
+} MMN_TRANS_CONTEXT;
@@ -1,77 +1,200 @@
-//==============================================================
-// Copyright  2020 Intel Corporation
-//
-// SPDX-License-Identifier: MIT
-// =============================================================
-
-#pragma once
-
-#include "mm_types.hpp"
-#include "usm_string.hpp"
-
-class mm_vector
-{
-public:
-	static bool exists(const MMN_ITEM* items_buf, \
-		const std::size_t items_size, const char* item) {
-		bool exists = false;
-		for (std::size_t ii = 0; ii < items_size && !exists; ii++)
-			exists = (strcmp(items_buf[ii].m_buf, item) == 0);
-
-		return exists;
-	}
-
-	static bool exists(const MMN_ITEM* items_buf, \
-		const std::size_t items_size, const MMN_ITEM& item) {
-			return exists(items_buf, items_size, item.m_buf);
-	}
-
-	static std::size_t intersect_vec( \
-		MMN_ITEM* items_buf1, const std::size_t items_buf1_size, \
-		MMN_ITEM* items_buf2, const std::size_t items_buf2_size)
-	{
-		std::size_t isect_size = 0L;
-		for (std::size_t ii = 0; ii < items_buf1_size; ii++)
-			isect_size += exists(items_buf2, items_buf2_size, items_buf1[ii]);
-
-		return isect_size;
-	}
-
-	static std::size_t union_vec(const MMN_ITEM* items_buf1, const std::size_t items_buf1_size, \
-		const MMN_ITEM* items_buf2, const std::size_t items_buf2_size, MMN_ITEM*& union_vec)
-	{
-		std::size_t union_size = 0L;
-		for (std::size_t ii = 0; ii < items_buf1_size; ii++)
-			usm_string_helper::strcpy(union_vec[union_size++].m_buf, \
-				items_buf1[ii].m_size, items_buf1[ii].m_buf, items_buf1[ii].m_size);
-
-		for (std::size_t ii = 0; ii < items_buf2_size; ii++)
-			if (!exists(items_buf1, items_buf1_size, items_buf2[ii]))
-				usm_string_helper::strcpy(union_vec[union_size++].m_buf, \
-					items_buf2[ii].m_size, items_buf2[ii].m_buf, items_buf2[ii].m_size);
-
-		return union_size;
-	}
-
-	static bool is_equal_vec(const MMN_ITEM* items_buf1, const std::size_t items_buf1_size, \
-		const MMN_ITEM* items_buf2, const std::size_t items_buf2_size)
-	{
-		bool is_equal = true;
-		if (items_buf1_size != items_buf2_size)	return !is_equal;
-		for (std::size_t ii = 0; ii < items_buf1_size && is_equal; ii++)
-			is_equal = (!strcmp(items_buf1[ii].m_buf, items_buf2[ii].m_buf));
-			
-		return is_equal;
-	}
-
-	static std::string to_string( \
-		const MMN_ITEM* item, const std::size_t size)
-	{
-		std::string result = "\0";
-		for (std::size_t i = 0; i < size; i++)
-			result += ((strcmp(item[i].m_buf, "\0") != 0) ? std::string(item[i].m_buf) : \
-				"N/A") + ((i != size - 1) ? "," : "\0");
-
-		return result;
-	}
-};
\ No newline at end of file
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#if !defined(__SYCL_DEVICE_ONLY__) && defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "mm_types.hpp"
+
+// itemsets are kept in canonical (ascending item ID, duplicate-free) order,
+// so every set operation below is a linear merge
+constexpr std::size_t g_short_set_len = 8;
+
+class mm_vector
+{
+public:
+	static bool exists(const MMN_ITEM_ID* items_buf, \
+		const std::size_t items_size, const MMN_ITEM_ID item) {
+		std::size_t first = 0L, last = items_size;
+		while (first < last) {
+			std::size_t mid = first + (last - first) / 2;
+			if (items_buf[mid] < item) first = mid + 1;
+			else last = mid;
+		}
+
+		return (first < items_size) && (items_buf[first] == item);
+	}
+
+	static std::size_t intersect_vec( \
+		const MMN_ITEM_ID* items_buf1, const std::size_t items_buf1_size, \
+		const MMN_ITEM_ID* items_buf2, const std::size_t items_buf2_size)
+	{
+#if !defined(__SYCL_DEVICE_ONLY__) && defined(__AVX2__)
+		if (items_buf1_size <= g_short_set_len)
+			return intersect_short(items_buf1, items_buf1_size, items_buf2, items_buf2_size);
+		if (items_buf2_size <= g_short_set_len)
+			return intersect_short(items_buf2, items_buf2_size, items_buf1, items_buf1_size);
+#endif
+		std::size_t isect_size = 0L;
+		std::size_t ii = 0L, jj = 0L;
+		while ((ii < items_buf1_size) && (jj < items_buf2_size))
+		{
+			if (items_buf1[ii] < items_buf2[jj]) ii++;
+			else if (items_buf2[jj] < items_buf1[ii]) jj++;
+			else { isect_size++; ii++; jj++; }
+		}
+
+		return isect_size;
+	}
+
+	static bool is_subset_vec( \
+		const MMN_ITEM_ID* items_buf1, const std::size_t items_buf1_size, \
+		const MMN_ITEM_ID* items_buf2, const std::size_t items_buf2_size)
+	{
+		if (items_buf1_size > items_buf2_size) return false;
+#if !defined(__SYCL_DEVICE_ONLY__) && defined(__AVX2__)
+		if (items_buf1_size <= g_short_set_len)
+			return intersect_short(items_buf1, items_buf1_size, \
+				items_buf2, items_buf2_size) == items_buf1_size;
+#endif
+		std::size_t ii = 0L, jj = 0L;
+		while ((ii < items_buf1_size) && (jj < items_buf2_size) && \
+			(items_buf2_size - jj >= items_buf1_size - ii))
+		{
+			if (items_buf2[jj] < items_buf1[ii]) jj++;
+			else if (items_buf2[jj] == items_buf1[ii]) { ii++; jj++; }
+			else return false;
+		}
+
+		return (ii == items_buf1_size);
+	}
+
+	// the same test for a subset whose items come in any order
+	static bool contains_vec( \
+		const MMN_ITEM_ID* items_buf1, const std::size_t items_buf1_size, \
+		const MMN_ITEM_ID* items_buf2, const std::size_t items_buf2_size)
+	{
+		if (items_buf1_size > items_buf2_size) return false;
+		for (std::size_t ii = 0; ii < items_buf1_size; ii++)
+			if (exists(items_buf2, items_buf2_size, items_buf1[ii]) == false)
+				return false;
+
+		return true;
+	}
+
+	static std::size_t union_vec(const MMN_ITEM_ID* items_buf1, const std::size_t items_buf1_size, \
+		const MMN_ITEM_ID* items_buf2, const std::size_t items_buf2_size, MMN_ITEM_ID* union_vec)
+	{
+		std::size_t union_size = 0L;
+		std::size_t ii = 0L, jj = 0L;
+		while ((ii < items_buf1_size) && (jj < items_buf2_size))
+		{
+			if (items_buf1[ii] < items_buf2[jj])
+				union_vec[union_size++] = items_buf1[ii++];
+			else if (items_buf2[jj] < items_buf1[ii])
+				union_vec[union_size++] = items_buf2[jj++];
+			else { union_vec[union_size++] = items_buf1[ii++]; jj++; }
+		}
+
+		while (ii < items_buf1_size)
+			union_vec[union_size++] = items_buf1[ii++];
+		while (jj < items_buf2_size)
+			union_vec[union_size++] = items_buf2[jj++];
+
+		return union_size;
+	}
+
+	static bool is_equal_vec(const MMN_ITEM_ID* items_buf1, const std::size_t items_buf1_size, \
+		const MMN_ITEM_ID* items_buf2, const std::size_t items_buf2_size)
+	{
+		bool is_equal = true;
+		if (items_buf1_size != items_buf2_size)	return !is_equal;
+		for (std::size_t ii = 0; ii < items_buf1_size && is_equal; ii++)
+			is_equal = (items_buf1[ii] == items_buf2[ii]);
+
+		return is_equal;
+	}
+
+	// FNV-1a over the item IDs with a final avalanche; equal canonical itemsets hash equally
+	static std::uint64_t hash_vec(const MMN_ITEM_ID* items_buf, const std::size_t items_size)
+	{
+		std::uint64_t hash = 0xcbf29ce484222325ULL ^ items_size;
+		for (std::size_t ii = 0; ii < items_size; ii++)
+			hash = (hash ^ items_buf[ii]) * 0x100000001b3ULL;
+
+		hash ^= hash >> 33; hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 33; hash *= 0xc4ceb9fe1a85ec53ULL;
+
+		return hash ^ (hash >> 33);
+	}
+
+	static int compare_vec(const MMN_ITEM_ID* items_buf1, const std::size_t items_buf1_size, \
+		const MMN_ITEM_ID* items_buf2, const std::size_t items_buf2_size)
+	{
+		for (std::size_t ii = 0; ii < items_buf1_size && ii < items_buf2_size; ii++)
+			if (items_buf1[ii] != items_buf2[ii])
+				return (items_buf1[ii] < items_buf2[ii]) ? -1 : 1;
+
+		return (items_buf1_size < items_buf2_size) ? -1 : \
+			(items_buf1_size > items_buf2_size) ? 1 : 0;
+	}
+
+	static void sort_vec(MMN_ITEM_ID* items_buf, const std::size_t items_size)
+	{
+		for (std::size_t ii = 1; ii < items_size; ii++)
+		{
+			MMN_ITEM_ID item = items_buf[ii]; std::size_t jj = ii;
+			for (; jj > 0 && items_buf[jj - 1] > item; jj--)
+				items_buf[jj] = items_buf[jj - 1];
+			items_buf[jj] = item;
+		}
+	}
+
+	static std::string to_string(const MMN_ITEM_ID* item, \
+		const std::size_t size, const MMN_ITEM* items_dict)
+	{
+		std::string result = "\0";
+		for (std::size_t i = 0; i < size; i++)
+			result += ((items_dict[item[i]].m_buf != nullptr) ? std::string(items_dict[item[i]].m_buf) : \
+				"N/A") + ((i != size - 1) ? "," : "\0");
+
+		return result;
+	}
+
+private:
+#if !defined(__SYCL_DEVICE_ONLY__) && defined(__AVX2__)
+	// broadcasts each item of the longer set against the (at most 8 items) short set
+	static std::size_t intersect_short( \
+		const MMN_ITEM_ID* short_buf, const std::size_t short_size, \
+		const MMN_ITEM_ID* items_buf, const std::size_t items_size)
+	{
+		if ((short_size == 0L) || (items_size == 0L)) return 0L;
+
+		alignas(32) MMN_ITEM_ID lanes[g_short_set_len];
+		for (std::size_t ii = 0; ii < g_short_set_len; ii++)
+			lanes[ii] = (ii < short_size) ? short_buf[ii] : short_buf[0];
+
+		const __m256i short_v = _mm256_load_si256((const __m256i*)lanes);
+		const MMN_ITEM_ID short_min = short_buf[0], short_max = short_buf[short_size - 1];
+
+		std::size_t isect_size = 0L;
+		for (std::size_t jj = 0; jj < items_size; jj++)
+		{
+			if (items_buf[jj] < short_min) continue;
+			if (items_buf[jj] > short_max) break;
+
+			__m256i eq_v = _mm256_cmpeq_epi32(short_v, \
+				_mm256_set1_epi32(static_cast<int>(items_buf[jj])));
+			isect_size += (_mm256_movemask_epi8(eq_v) != 0);
+		}
+
+		return isect_size;
+	}
+#endif
+};
@@ -1,310 +1,546 @@
-//==============================================================
-// Copyright  2020 Intel Corporation
-//
-// SPDX-License-Identifier: MIT
-// =============================================================
-
-#pragma once
-
-#include <tbb/tbb.h>
-#include <tbb/parallel_for.h>
-
-#include <memory>
-
-#include "mm_types.hpp"
-
-typedef enum {
-	usm_alloc_crt	 = 0x01,
-	usm_alloc_host	 = 0x02,
-	usm_alloc_device = 0x03,
-	usm_alloc_shared = 0x04
-} USM_ALLOC_TYPE;
-
-constexpr unsigned short g_threads = 36;
-
-class sycl_usm_alloc_ptr
-{
-public:
-	sycl_usm_alloc_ptr(\
-		const char* context_name, \
-		USM_ALLOC_TYPE alloc_type = USM_ALLOC_TYPE::usm_alloc_crt) : \
-			m_alloc_type(alloc_type), m_context_name(context_name) {};
-
-public:
-	template<class Type>
-	void alloc_buffer(Type*& buf_ptr, const std::size_t size) {
-		if ((size > 0L) && (buf_ptr == nullptr)) {
-			buf_ptr = alloc_buf_async<Type>(size * sizeof(Type));
-		}
-	}
-	
-	template<class Type>
-	void free_buffer(Type*& buf_ptr) {
-		if (buf_ptr != nullptr) {
-			switch (m_alloc_type) {
-				case USM_ALLOC_TYPE::usm_alloc_crt:
-					std::free(buf_ptr); break;
-				default: break;
-			}
-
-			buf_ptr = nullptr;
-		}
-	}
-
-//private:
-public:
-	template<class Type>
-	Type* alloc_buf_async(const std::size_t size) {
- 	    bool alloc_failed = false;
-		Type* buf_ptr_local = nullptr;
-		//do {
-			try {
-				alloc_failed = false;
-				switch (m_alloc_type) {
-					case USM_ALLOC_TYPE::usm_alloc_crt:
-						buf_ptr_local = static_cast<Type*>(std::malloc(size)); break;
-					default: buf_ptr_local = nullptr; break;
-				}
-
-				switch (m_alloc_type) {
-					case USM_ALLOC_TYPE::usm_alloc_crt: 
-						std::memset((void*)buf_ptr_local, 0x00, size); break;
-					default: break;
-				}
-			}
-			catch (std::bad_alloc& e) {
-				alloc_failed = true;
-				std::cerr << "Error: (" << m_context_name << \
-					") memory buffer allocation failure: " << e.what() << "\n";
-			}
-		//} while ((alloc_failed != false) || \
-		//	(buf_ptr_local == nullptr));
-
-		return buf_ptr_local;
-	}
-
-	template<class Type>
-	void realloc_buf_async(Type*& buf_ptr, const std::size_t size) {
-		bool alloc_failed = false;
-		//do {
-		try {
-			buf_ptr = static_cast<Type*>( \
-				std::realloc(buf_ptr, size * sizeof(Type)));
-		}
-		catch (std::bad_alloc& e) {
-			alloc_failed = true;
-			std::cerr << "Error: (" << m_context_name << \
-				") memory buffer re-allocation failure: " << e.what() << "\n";
-		}
-		//} while ((alloc_failed != false) || \
-		//	(buf_ptr_local == nullptr));
-	}
-
-protected:
-	const USM_ALLOC_TYPE m_alloc_type;
-	const char*			 m_context_name;
-};
-
-class sycl_usm_alloc_helper : \
-	public sycl_usm_alloc_ptr
-{
-public:
-	sycl_usm_alloc_helper(const char* context_name, \
-		USM_ALLOC_TYPE alloc_type = USM_ALLOC_TYPE::usm_alloc_crt) : \
-			sycl_usm_alloc_ptr(context_name, alloc_type) {}
-
-public:
-	/*void alloc_trans_buf(MMN_TRANS*& trans_buf, const std::size_t trans, \
-		const std::size_t items_per_trans, const std::size_t item_size) {
-
-		//tbb::task_group task_group;
-		//auto mp = tbb::global_control::max_allowed_parallelism;
-		//tbb::global_control gc(mp, g_threads);
-
-		//task_group.run_and_wait([&]() {
-			if ((trans_buf == nullptr) && (trans > 0L) && \
-				(items_per_trans > 0L) && (item_size > 0L)) {
-				alloc_buffer<MMN_TRANS>(trans_buf, trans);
-				//tbb::parallel_for(tbb::blocked_range<std::size_t>(0, trans), \
-				//	[&](const tbb::blocked_range<std::size_t>& r) {
-						//for (std::size_t ii = r.begin(); ii != r.end(); ii++)
-						for (std::size_t ii = 0; ii < trans; ii++)
-						{
-							trans_buf[ii].m_items = items_per_trans;
-							alloc_items_buf(trans_buf[ii].m_v, items_per_trans, item_size);
-						}
-				//	});
-			}
-		//});
-	}*/
-
-	void alloc_cnds_buf(MMN_RULE*& cnds_buf, const std::size_t cnds, \
-		const std::size_t items_per_cnd, const std::size_t item_len)
-	{
-		//if (rules_buf != nullptr)
-		//	free_rules_buf(rules_buf, rules, items_per_rule);
-
-		//tbb::task_group task_group;
-		//auto mp = tbb::global_control::max_allowed_parallelism;
-		//tbb::global_control gc(mp, g_threads);
-
-		//task_group.run_and_wait([&]() {
-		if ((cnds_buf == nullptr) && (cnds > 0L) && \
-			(items_per_cnd > 0L) && (item_len > 0L)) {
-			alloc_buffer<MMN_RULE>(cnds_buf, cnds);
-			//tbb::parallel_for(tbb::blocked_range<std::size_t>(0, rules), \
-				//[&](const tbb::blocked_range<std::size_t>& r) {
-					//for (std::size_t ii = r.begin(); ii != r.end(); ii++)
-					for (std::size_t ii = 0; ii < cnds; ii++)
-						alloc_cnds_node(cnds_buf[ii], items_per_cnd, item_len);
-				//});
-		}
-		//});
-	}
-
-	void alloc_trans_ctx(\
-		MMN_TRANS_CONTEXT*& trans_ctx, const MMN_ITEM* items_buf, \
-		const MMN_TRANS* trans_buf, const MMN_TRANS_STATS stats) {
-		if (trans_ctx == nullptr) {
-			MMN_TRANS_CONTEXT* context = nullptr;
-			alloc_buffer<MMN_TRANS_CONTEXT>(context, 1);
-
-			if ((items_buf != nullptr) && (trans_buf != nullptr)) {
-				context->m_stats = stats;
-				context->m_items = const_cast<MMN_ITEM*>(items_buf);
-				context->m_trans = const_cast<MMN_TRANS*>(trans_buf);
-			}
-
-			if ((context->m_items != nullptr) && \
-				(context->m_trans != nullptr)) {
-				trans_ctx = context;
-			}
-		}
-	}
-
-public:
-	void free_trans_buf(MMN_TRANS*& trans_buf, const std::size_t trans) {
-
-		//tbb::task_group task_group;
-		//auto mp = tbb::global_control::max_allowed_parallelism;
-		//tbb::global_control gc(mp, g_threads);
-
-		//task_group.run_and_wait([&]() {
-		if ((trans_buf != nullptr) && (trans > 0L)) {
-			//tbb::parallel_for(tbb::blocked_range<std::size_t>(0, trans), \
-			//	[&](const tbb::blocked_range<std::size_t>& r) {
-					//for (std::size_t ii = r.begin(); ii != r.end(); ii++)
-			for (std::size_t ii = 0; ii < trans; ii++) {
-				//free_items_buf(trans_buf[ii].m_v, trans_buf[ii].m_items); trans_buf[ii].m_v = nullptr;
-			}
-			//	});
-
-			/*free_buffer<MMN_TRANS>(trans_buf);*/ trans_buf = nullptr;
-		}
-		//});
-	}
-	
-	void free_cnds_buf(MMN_RULE*& cnds_buf, const std::size_t cnds) 
-	{
-		if ((cnds_buf != nullptr) && (cnds > 0L)) {
-			tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
-				[&](const tbb::blocked_range<std::size_t>& r) {
-					for (std::size_t ii = r.begin(); ii != r.end(); ii++)
-						free_rule_node(&cnds_buf[ii], cnds_buf[ii].m_items);
-				});
-
-			free_buffer<MMN_RULE>(cnds_buf); cnds_buf = nullptr;
-		}
-	}
-
-	void free_trans_ctx(MMN_TRANS_CONTEXT*& trans_ctx) {
-		if (trans_ctx != nullptr) {
-
-			//free_items_buf(trans_ctx->m_tokens, trans_ctx->m_stats.m_tokens_count);
-			//free_trans_buf(trans_ctx->m_trans_ptr, trans_ctx->m_stats.m_trans_count);
-
-			/*free_buffer<MMN_TRANS_CONTEXT>(trans_ctx);*/ trans_ctx = nullptr;
-		}
-	}
-
-public:
-	void alloc_items_buf(MMN_ITEM*& items_buf, \
-		const std::size_t items_size, const std::size_t item_len) {
-
-		//tbb::task_group task_group;
-		//auto mp = tbb::global_control::max_allowed_parallelism;
-		//tbb::global_control gc(mp, g_threads);
-
-		//task_group.run_and_wait([&]() {
-		if ((items_buf == nullptr) && (items_size > 0L)) {
-			alloc_buffer<MMN_ITEM>(items_buf, items_size);
-			//tbb::parallel_for(tbb::blocked_range<std::size_t>(0, size), \
-				//	[&](const tbb::blocked_range<std::size_t>& r) {
-						//for (std::size_t ii = r.begin(); ii != r.end(); ii++)
-			for (std::size_t ii = 0; ii < items_size; ii++)
-			{
-				items_buf[ii].m_size = item_len;
-				alloc_buffer<char>(items_buf[ii].m_buf, item_len);
-				if (m_alloc_type == USM_ALLOC_TYPE::usm_alloc_crt)
-					std::memset((void*)items_buf[ii].m_buf, 0x00, item_len);
-			}
-			//});
-		}
-		//});
-	}
-
-	void alloc_cnds_node(MMN_RULE& cnds, \
-		const std::size_t cnds_size, const std::size_t item_len)
-	{
-		//tbb::task_group task_group;
-		//auto mp = tbb::global_control::max_allowed_parallelism;
-		//tbb::global_control gc(mp, g_threads);
-
-		//task_group.run_and_wait([&]() {
-		if ((cnds.m_v == nullptr) && (cnds_size > 0L)) {
-			cnds.m_items = cnds_size; /*cnds.m_supp_a = */cnds.m_supp_ab = .0f;
-			alloc_items_buf(cnds.m_v, cnds.m_items, item_len);
-		}
-		//});
-	}
-
-public:
-	void free_items_buf(MMN_ITEM*& items_buf, const std::size_t items_size) {
-
-		//tbb::task_group task_group;
-		//auto mp = tbb::global_control::max_allowed_parallelism;
-		//tbb::global_control gc(mp, g_threads);
-
-		//task_group.run_and_wait([&]() {
-		if ((items_buf != nullptr) && (items_size > 0L)) {
-			//tbb::parallel_for(tbb::blocked_range<std::size_t>(0, size), \
-			//	[&](const tbb::blocked_range<std::size_t>& r) {
-					//for (std::size_t ii = r.begin(); ii != r.end(); ii++) {
-					for (std::size_t ii = 0; ii < items_size; ii++) {
-						free_buffer<char>(items_buf[ii].m_buf); 
-						items_buf[ii].m_buf = nullptr;
-					}
-				//});
-
-			free_buffer<MMN_ITEM>(items_buf); 
-			items_buf = nullptr;
-		}
-		//});
-	}
-
-	void free_rule_node(MMN_RULE* rule, const std::size_t items)
-	{
-		//tbb::task_group task_group;
-		//auto mp = tbb::global_control::max_allowed_parallelism;
-		//tbb::global_control gc(mp, g_threads);
-
-		//task_group.run_and_wait([&]() {
-		if ((rule->m_v != nullptr) && (items > 0L)) {
-			rule->m_items = 0L; /*rule->m_supp_a = */rule->m_supp_ab = .0f;
-			free_items_buf(rule->m_v, rule->m_items);
-		}
-
-		/*free_buffer<MMN_RULE>(rule);*/ rule = nullptr;
-		//});
-	}
+//==============================================================
+// Copyright  2020 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+// =============================================================
+
+#pragma once
+
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/enumerable_thread_specific.h>
+
+// the SYCL paths are built by a SYCL compiler, or on request; a plain C++ build
+// allocates every USM type from the CRT and runs the kernels on a host backend
+#if defined(SYCL_LANGUAGE_VERSION) && !defined(MM_BACKEND_SYCL)
+#define MM_BACKEND_SYCL
+#endif
+
+#if defined(MM_BACKEND_SYCL)
+#include <CL/sycl.hpp>
+#endif
+
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+#include "mm_types.hpp"
+
+typedef enum {
+	usm_alloc_crt	 = 0x01,
+	usm_alloc_host	 = 0x02,
+	usm_alloc_device = 0x03,
+	usm_alloc_shared = 0x04
+} USM_ALLOC_TYPE;
+
+constexpr std::size_t g_arena_align = 64L;
+constexpr std::size_t g_arena_slab_size = 1L << 22;
+
+// the one queue of a run: every kernel is submitted to it and every USM allocation
+// belongs to its context, so no chunk pays for a queue of its own
+class sycl_usm_queue
+{
+public:
+#if defined(MM_BACKEND_SYCL)
+	static cl::sycl::queue& get()
+	{
+		static cl::sycl::queue device_queue(cl::sycl::cpu_selector{}, \
+			[](cl::sycl::exception_list exceptions) {
+				for (std::exception_ptr const& e : exceptions) {
+					try { std::rethrow_exception(e); }
+					catch (cl::sycl::exception const& ex) {
+						std::cerr << "Error: (sycl_usm_queue) asynchronous exception: " << ex.what() << "\n";
+					}
+				}
+			});
+
+		return device_queue;
+	}
+#endif
+
+	static void* malloc(const std::size_t size, [[maybe_unused]] const USM_ALLOC_TYPE alloc_type)
+	{
+#if !defined(MM_BACKEND_SYCL)
+		return std::malloc(size);
+#else
+		switch (alloc_type) {
+			case USM_ALLOC_TYPE::usm_alloc_host:
+				return cl::sycl::malloc_host(size, get());
+			case USM_ALLOC_TYPE::usm_alloc_device:
+				return cl::sycl::malloc_device(size, get());
+			case USM_ALLOC_TYPE::usm_alloc_shared:
+				return cl::sycl::malloc_shared(size, get());
+			default: return std::malloc(size);
+		}
+#endif
+	}
+
+	static void free(void* buf_ptr, [[maybe_unused]] const USM_ALLOC_TYPE alloc_type)
+	{
+#if defined(MM_BACKEND_SYCL)
+		if (alloc_type != USM_ALLOC_TYPE::usm_alloc_crt) {
+			cl::sycl::free(buf_ptr, get()); return;
+		}
+#endif
+		std::free(buf_ptr);
+	}
+
+	// device allocations are not accessible from the host, so they are cleared by the queue
+	static void zero(void* buf_ptr, const std::size_t size, [[maybe_unused]] const USM_ALLOC_TYPE alloc_type)
+	{
+#if defined(MM_BACKEND_SYCL)
+		if (alloc_type == USM_ALLOC_TYPE::usm_alloc_device) {
+			get().memset(buf_ptr, 0x00, size).wait_and_throw(); return;
+		}
+#endif
+		std::memset(buf_ptr, 0x00, size);
+	}
+
+	static void copy(void* dst_ptr, const void* src_ptr, const std::size_t size) {
+#if defined(MM_BACKEND_SYCL)
+		get().memcpy(dst_ptr, src_ptr, size).wait_and_throw();
+#else
+		std::memcpy(dst_ptr, src_ptr, size);
+#endif
+	}
+};
+
+class sycl_usm_arena
+{
+public:
+	sycl_usm_arena(const char* context_name, \
+		const std::size_t slab_size = g_arena_slab_size, \
+		const USM_ALLOC_TYPE alloc_type = USM_ALLOC_TYPE::usm_alloc_crt) : \
+			m_context_name(context_name), m_slab_size(slab_size), m_alloc_type(alloc_type) {};
+	virtual ~sycl_usm_arena() { release(); }
+
+	sycl_usm_arena(const sycl_usm_arena&) = delete;
+	sycl_usm_arena& operator=(const sycl_usm_arena&) = delete;
+
+public:
+	void* alloc(std::size_t size)
+	{
+		size = (size + g_arena_align - 1) & ~(g_arena_align - 1);
+
+		// slabs are private to the calling thread, so bumping needs no lock
+		MMN_ARENA_SLABS& slabs = m_slabs.local();
+		while (slabs.m_current < slabs.m_slabs.size())
+		{
+			MMN_ARENA_SLAB& slab = slabs.m_slabs[slabs.m_current];
+			if (slab.m_used + size <= slab.m_size) {
+				void* buf_ptr = slab.m_buf + slab.m_used;
+				slab.m_used += size; return buf_ptr;
+			}
+
+			slabs.m_current++;
+		}
+
+		MMN_ARENA_SLAB slab = { nullptr, std::max(m_slab_size, size), size };
+		slab.m_buf = static_cast<char*>(sycl_usm_queue::malloc(slab.m_size, m_alloc_type));
+		if (slab.m_buf == nullptr) {
+			std::cerr << "Error: (" << m_context_name << \
+				") arena slab allocation failure\n";
+			return nullptr;
+		}
+
+		slabs.m_slabs.push_back(slab);
+		slabs.m_current = slabs.m_slabs.size() - 1;
+
+		return slab.m_buf;
+	}
+
+	// rewinds every slab at once; the slabs are kept for the next level
+	void reset() {
+		for (auto& slabs : m_slabs) {
+			for (auto& slab : slabs.m_slabs)
+				slab.m_used = 0L;
+			slabs.m_current = 0L;
+		}
+	}
+
+	void release() {
+		for (auto& slabs : m_slabs) {
+			for (auto& slab : slabs.m_slabs)
+				sycl_usm_queue::free(slab.m_buf, m_alloc_type);
+			slabs.m_slabs.clear();
+			slabs.m_current = 0L;
+		}
+	}
+
+	USM_ALLOC_TYPE alloc_type() const { return m_alloc_type; }
+
+private:
+	typedef struct {
+		char* m_buf;
+		std::size_t m_size;
+		std::size_t m_used;
+	} MMN_ARENA_SLAB;
+
+	typedef struct {
+		std::vector<MMN_ARENA_SLAB> m_slabs;
+		std::size_t m_current = 0L;
+	} MMN_ARENA_SLABS;
+
+	const char*		m_context_name;
+	const std::size_t	m_slab_size;
+	const USM_ALLOC_TYPE m_alloc_type;
+	tbb::enumerable_thread_specific<MMN_ARENA_SLABS> m_slabs;
+};
+
+class sycl_usm_alloc_ptr
+{
+public:
+	sycl_usm_alloc_ptr(\
+		const char* context_name, \
+		USM_ALLOC_TYPE alloc_type = USM_ALLOC_TYPE::usm_alloc_crt, \
+		sycl_usm_arena* arena = nullptr) : \
+			m_alloc_type(alloc_type), m_context_name(context_name), m_arena(arena) {};
+
+public:
+	template<class Type>
+	void alloc_buffer(Type*& buf_ptr, const std::size_t size) {
+		if ((size > 0L) && (buf_ptr == nullptr)) {
+			buf_ptr = alloc_buf_async<Type>(size * sizeof(Type));
+		}
+	}
+	
+	template<class Type>
+	void free_buffer(Type*& buf_ptr) {
+		if ((buf_ptr != nullptr) && (m_arena == nullptr)) {
+			sycl_usm_queue::free(buf_ptr, m_alloc_type);
+			buf_ptr = nullptr;
+		}
+	}
+
+//private:
+public:
+	template<class Type>
+	Type* alloc_buf_async(const std::size_t size) {
+ 	    bool alloc_failed = false;
+		Type* buf_ptr_local = nullptr;
+		//do {
+			try {
+				alloc_failed = false;
+				if (m_arena != nullptr) {
+					buf_ptr_local = static_cast<Type*>(m_arena->alloc(size));
+					if (buf_ptr_local != nullptr)
+						sycl_usm_queue::zero((void*)buf_ptr_local, size, m_arena->alloc_type());
+					return buf_ptr_local;
+				}
+
+				buf_ptr_local = static_cast<Type*>(sycl_usm_queue::malloc(size, m_alloc_type));
+				if (buf_ptr_local != nullptr)
+					sycl_usm_queue::zero((void*)buf_ptr_local, size, m_alloc_type);
+			}
+			catch (std::bad_alloc& e) {
+				alloc_failed = true;
+				std::cerr << "Error: (" << m_context_name << \
+					") memory buffer allocation failure: " << e.what() << "\n";
+			}
+#if defined(MM_BACKEND_SYCL)
+			catch (cl::sycl::exception& e) {
+				alloc_failed = true;
+				std::cerr << "Error: (" << m_context_name << \
+					") USM buffer allocation failure: " << e.what() << "\n";
+			}
+#endif
+		//} while ((alloc_failed != false) || \
+		//	(buf_ptr_local == nullptr));
+
+		return buf_ptr_local;
+	}
+
+	// USM buffers cannot grow in place: they move to a new allocation
+	// that keeps the first `keep` elements
+	template<class Type>
+	void realloc_buf_async(Type*& buf_ptr, const std::size_t size, const std::size_t keep = 0L) {
+		bool alloc_failed = false;
+		//do {
+		try {
+			if (m_alloc_type != USM_ALLOC_TYPE::usm_alloc_crt) {
+				Type* buf_ptr_new = static_cast<Type*>(\
+					sycl_usm_queue::malloc(size * sizeof(Type), m_alloc_type));
+				if ((buf_ptr != nullptr) && (buf_ptr_new != nullptr) && (keep > 0L))
+					sycl_usm_queue::copy(buf_ptr_new, buf_ptr, std::min(keep, size) * sizeof(Type));
+				if (buf_ptr != nullptr)
+					sycl_usm_queue::free(buf_ptr, m_alloc_type);
+
+				buf_ptr = buf_ptr_new; return;
+			}
+
+			buf_ptr = static_cast<Type*>( \
+				std::realloc(buf_ptr, size * sizeof(Type)));
+		}
+		catch (std::bad_alloc& e) {
+			alloc_failed = true;
+			std::cerr << "Error: (" << m_context_name << \
+				") memory buffer re-allocation failure: " << e.what() << "\n";
+		}
+		//} while ((alloc_failed != false) || \
+		//	(buf_ptr_local == nullptr));
+	}
+
+	// makes room for element [size] of a buffer holding grow_capacity(size) elements
+	template<class Type>
+	void realloc_buf_grow(Type*& buf_ptr, const std::size_t size) {
+		if ((size & (size - 1)) == 0L)
+			realloc_buf_async<Type>(buf_ptr, grow_capacity(size + 1), size);
+	}
+
+	static std::size_t grow_capacity(const std::size_t size) {
+		std::size_t capacity = 1L;
+		while (capacity < size) capacity <<= 1;
+		return (size > 0L) ? capacity : 0L;
+	}
+
+protected:
+	const USM_ALLOC_TYPE m_alloc_type;
+	const char*			 m_context_name;
+	sycl_usm_arena*		 m_arena;
+};
+
+class sycl_usm_alloc_helper : \
+	public sycl_usm_alloc_ptr
+{
+public:
+	sycl_usm_alloc_helper(const char* context_name, \
+		USM_ALLOC_TYPE alloc_type = USM_ALLOC_TYPE::usm_alloc_crt, \
+		sycl_usm_arena* arena = nullptr) : \
+			sycl_usm_alloc_ptr(context_name, alloc_type, arena) {}
+
+public:
+	/*void alloc_trans_buf(MMN_TRANS*& trans_buf, const std::size_t trans, \
+		const std::size_t items_per_trans, const std::size_t item_size) {
+
+		//tbb::task_group task_group;
+		//auto mp = tbb::global_control::max_allowed_parallelism;
+		//tbb::global_control gc(mp, g_threads);
+
+		//task_group.run_and_wait([&]() {
+			if ((trans_buf == nullptr) && (trans > 0L) && \
+				(items_per_trans > 0L) && (item_size > 0L)) {
+				alloc_buffer<MMN_TRANS>(trans_buf, trans);
+				//tbb::parallel_for(tbb::blocked_range<std::size_t>(0, trans), \
+				//	[&](const tbb::blocked_range<std::size_t>& r) {
+						//for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+						for (std::size_t ii = 0; ii < trans; ii++)
+						{
+							trans_buf[ii].m_items = items_per_trans;
+							alloc_items_buf(trans_buf[ii].m_v, items_per_trans, item_size);
+						}
+				//	});
+			}
+		//});
+	}*/
+
+	void alloc_cnds_buf(MMN_RULE*& cnds_buf, const std::size_t cnds, \
+		const std::size_t items_per_cnd)
+	{
+		//if (rules_buf != nullptr)
+		//	free_rules_buf(rules_buf, rules, items_per_rule);
+
+		//tbb::task_group task_group;
+		//auto mp = tbb::global_control::max_allowed_parallelism;
+		//tbb::global_control gc(mp, g_threads);
+
+		//task_group.run_and_wait([&]() {
+		if ((cnds_buf == nullptr) && (cnds > 0L) && \
+			(items_per_cnd > 0L)) {
+			alloc_buffer<MMN_RULE>(cnds_buf, cnds);
+			if (m_arena != nullptr) {
+				tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
+					[&](const tbb::blocked_range<std::size_t>& r) {
+						for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+							alloc_cnds_node(cnds_buf[ii], items_per_cnd);
+					});
+			}
+
+			else {
+				for (std::size_t ii = 0; ii < cnds; ii++)
+					alloc_cnds_node(cnds_buf[ii], items_per_cnd);
+			}
+		}
+		//});
+	}
+
+	void alloc_trans_ctx(\
+		MMN_TRANS_CONTEXT*& trans_ctx, const MMN_ITEM* items_buf, \
+		const MMN_TRANS* trans_buf, const MMN_TRANS_STATS stats) {
+		if (trans_ctx == nullptr) {
+			MMN_TRANS_CONTEXT* context = nullptr;
+			alloc_buffer<MMN_TRANS_CONTEXT>(context, 1);
+
+			if ((items_buf != nullptr) && (trans_buf != nullptr)) {
+				context->m_stats = stats;
+				context->m_items = const_cast<MMN_ITEM*>(items_buf);
+				context->m_trans = const_cast<MMN_TRANS*>(trans_buf);
+			}
+
+			if ((context->m_items != nullptr) && \
+				(context->m_trans != nullptr)) {
+				trans_ctx = context;
+			}
+		}
+	}
+
+public:
+	void free_trans_buf(MMN_TRANS*& trans_buf, const std::size_t trans) {
+
+		//tbb::task_group task_group;
+		//auto mp = tbb::global_control::max_allowed_parallelism;
+		//tbb::global_control gc(mp, g_threads);
+
+		//task_group.run_and_wait([&]() {
+		if ((trans_buf != nullptr) && (trans > 0L)) {
+			//tbb::parallel_for(tbb::blocked_range<std::size_t>(0, trans), \
+			//	[&](const tbb::blocked_range<std::size_t>& r) {
+					//for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+			for (std::size_t ii = 0; ii < trans; ii++) {
+				//free_items_buf(trans_buf[ii].m_v, trans_buf[ii].m_items); trans_buf[ii].m_v = nullptr;
+			}
+			//	});
+
+			/*free_buffer<MMN_TRANS>(trans_buf);*/ trans_buf = nullptr;
+		}
+		//});
+	}
+	
+	void free_cnds_buf(MMN_RULE*& cnds_buf, const std::size_t cnds) 
+	{
+		// arena-backed levels are released all at once by sycl_usm_arena::reset
+		if (m_arena != nullptr) {
+			cnds_buf = nullptr; return;
+		}
+
+		if ((cnds_buf != nullptr) && (cnds > 0L)) {
+			tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cnds), \
+				[&](const tbb::blocked_range<std::size_t>& r) {
+					for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+						free_rule_node(&cnds_buf[ii], cnds_buf[ii].m_items);
+				});
+
+			free_buffer<MMN_RULE>(cnds_buf); cnds_buf = nullptr;
+		}
+	}
+
+	void alloc_cnds_store(MMN_CNDS_STORE& cnds_store, \
+		const std::size_t cnds, const std::size_t pool_size)
+	{
+		cnds_store.m_cnds = cnds;
+		cnds_store.m_pool_size = pool_size;
+
+		alloc_buffer<MMN_ITEM_ID>(cnds_store.m_pool, pool_size);
+		alloc_buffer<std::size_t>(cnds_store.m_offs, cnds);
+		alloc_buffer<std::size_t>(cnds_store.m_items, cnds);
+		alloc_buffer<double>(cnds_store.m_conf, cnds);
+		alloc_buffer<double>(cnds_store.m_supp_a, cnds);
+		alloc_buffer<double>(cnds_store.m_supp_b, cnds);
+		alloc_buffer<double>(cnds_store.m_supp_ab, cnds);
+	}
+
+	void free_cnds_store(MMN_CNDS_STORE& cnds_store)
+	{
+		free_buffer<MMN_ITEM_ID>(cnds_store.m_pool);
+		free_buffer<std::size_t>(cnds_store.m_offs);
+		free_buffer<std::size_t>(cnds_store.m_items);
+		free_buffer<double>(cnds_store.m_conf);
+		free_buffer<double>(cnds_store.m_supp_a);
+		free_buffer<double>(cnds_store.m_supp_b);
+		free_buffer<double>(cnds_store.m_supp_ab);
+
+		cnds_store = MMN_CNDS_STORE{};
+	}
+
+	void free_trans_ctx(MMN_TRANS_CONTEXT*& trans_ctx) {
+		if (trans_ctx != nullptr) {
+
+			//free_items_buf(trans_ctx->m_tokens, trans_ctx->m_stats.m_tokens_count);
+			//free_trans_buf(trans_ctx->m_trans_ptr, trans_ctx->m_stats.m_trans_count);
+
+			/*free_buffer<MMN_TRANS_CONTEXT>(trans_ctx);*/ trans_ctx = nullptr;
+		}
+	}
+
+public:
+	void alloc_items_buf(MMN_ITEM*& items_buf, \
+		const std::size_t items_size, const std::size_t item_len) {
+
+		//tbb::task_group task_group;
+		//auto mp = tbb::global_control::max_allowed_parallelism;
+		//tbb::global_control gc(mp, g_threads);
+
+		//task_group.run_and_wait([&]() {
+		if ((items_buf == nullptr) && (items_size > 0L)) {
+			alloc_buffer<MMN_ITEM>(items_buf, items_size);
+			//tbb::parallel_for(tbb::blocked_range<std::size_t>(0, size), \
+				//	[&](const tbb::blocked_range<std::size_t>& r) {
+						//for (std::size_t ii = r.begin(); ii != r.end(); ii++)
+			for (std::size_t ii = 0; ii < items_size; ii++)
+			{
+				items_buf[ii].m_size = item_len;
+				alloc_buffer<char>(items_buf[ii].m_buf, item_len + 1);
+				if (m_alloc_type == USM_ALLOC_TYPE::usm_alloc_crt)
+					std::memset((void*)items_buf[ii].m_buf, 0x00, item_len + 1);
+			}
+			//});
+		}
+		//});
+	}
+
+	void alloc_cnds_node(MMN_RULE& cnds, const std::size_t cnds_size)
+	{
+		//tbb::task_group task_group;
+		//auto mp = tbb::global_control::max_allowed_parallelism;
+		//tbb::global_control gc(mp, g_threads);
+
+		//task_group.run_and_wait([&]() {
+		if ((cnds.m_v == nullptr) && (cnds_size > 0L)) {
+			cnds.m_items = cnds_size; /*cnds.m_supp_a = */cnds.m_supp_ab = .0f;
+			alloc_buffer<MMN_ITEM_ID>(cnds.m_v, cnds.m_items);
+		}
+		//});
+	}
+
+public:
+	void free_items_buf(MMN_ITEM*& items_buf, const std::size_t items_size) {
+
+		//tbb::task_group task_group;
+		//auto mp = tbb::global_control::max_allowed_parallelism;
+		//tbb::global_control gc(mp, g_threads);
+
+		//task_group.run_and_wait([&]() {
+		if ((items_buf != nullptr) && (items_size > 0L)) {
+			//tbb::parallel_for(tbb::blocked_range<std::size_t>(0, size), \
+			//	[&](const tbb::blocked_range<std::size_t>& r) {
+					//for (std::size_t ii = r.begin(); ii != r.end(); ii++) {
+					for (std::size_t ii = 0; ii < items_size; ii++) {
+						free_buffer<char>(items_buf[ii].m_buf); 
+						items_buf[ii].m_buf = nullptr;
+					}
+				//});
+
+			free_buffer<MMN_ITEM>(items_buf); 
+			items_buf = nullptr;
+		}
+		//});
+	}
+
+	void free_rule_node(MMN_RULE* rule, const std::size_t items)
+	{
+		//tbb::task_group task_group;
+		//auto mp = tbb::global_control::max_allowed_parallelism;
+		//tbb::global_control gc(mp, g_threads);
+
+		//task_group.run_and_wait([&]() {
+		if ((rule->m_v != nullptr) && (items > 0L)) {
+			rule->m_items = 0L; /*rule->m_supp_a = */rule->m_supp_ab = .0f;
+			free_buffer<MMN_ITEM_ID>(rule->m_v);
+		}
+
+		/*free_buffer<MMN_RULE>(rule);*/ rule = nullptr;
+		//});
+	}
 };
\ No newline at end of file